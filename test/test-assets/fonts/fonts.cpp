@@ -6,6 +6,8 @@
 
 #include "fonts.hpp"
 
+#include <cstdio>
+
 // text class constructor, sets up color, size, font, position, text message 
 TextClass::TextClass(sf::Vector2f position, unsigned int size, sf::Color color, std::weak_ptr<sf::Font> font, const std::string& testMessage)
     : position(position), size(size), color(color), font(font), text(std::make_unique<sf::Text>()) {
@@ -21,10 +23,10 @@ TextClass::TextClass(sf::Vector2f position, unsigned int size, sf::Color color,
         text->setPosition(position);
         text->setString(testMessage);
         
-        log_info("text initialized successully");
+        LOG_INFO(Assets, "text initialized successully");
     } 
     catch(const std::exception& e) {
-        log_error(e.what());  
+        LOG_ERROR(Assets, "{}", e.what());  
         visibleState = false;
     }
 }
@@ -34,6 +36,43 @@ void TextClass::updateText(const std::string& newText) {
     if (text) {
         text->setString(newText); 
     } else {
-        log_warning("Text not initialized"); 
+        LOG_WARNING(Assets, "Text not initialized"); 
     }
-}
\ No newline at end of file
+}
+
+// performance HUD, starts empty until the first refresh
+PerformanceHud::PerformanceHud(sf::Vector2f offset, unsigned int size, sf::Color color, std::weak_ptr<sf::Font> font, float refreshTime)
+    : text(offset, size, color, font, ""), offset(offset), refreshTime(refreshTime) {}
+
+void PerformanceHud::addFrame(const HudFrameStats& stats) {
+    total.frameTime += stats.frameTime;
+    total.simulationTime += stats.simulationTime;
+    total.drawTime += stats.drawTime;
+    total.drawCalls += stats.drawCalls;
+    total.collisionTests += stats.collisionTests;
+    total.cloudBlue = stats.cloudBlue;
+    total.cloudPurple = stats.cloudPurple;
+    total.coins = stats.coins;
+    total.quadtreeNodes = stats.quadtreeNodes;
+    total.quadtreeDepth = stats.quadtreeDepth;
+    ++frames;
+
+    if (total.frameTime >= refreshTime) refresh();
+}
+
+// writes the averages into the text and starts adding up again
+void PerformanceHud::refresh() {
+    float frameCount = static_cast<float>(frames);
+    float frameMs = total.frameTime / frameCount * 1000.0f;
+    std::snprintf(buffer.data(), buffer.size(), 
+                  "frame %.2f ms (%.0f fps)\nsimulation %.2f ms\ndraw %.2f ms\ndraw calls %.1f\n"
+                  "clouds %zu blue, %zu purple\ncoins %zu\nquadtree %zu nodes, depth %zu\ncollision tests %.1f", 
+                  frameMs, frameMs > 0.0f ? 1000.0f / frameMs : 0.0f, total.simulationTime / frameCount * 1000.0f, 
+                  total.drawTime / frameCount * 1000.0f, total.drawCalls / frameCount, total.cloudBlue, total.cloudPurple, total.coins, 
+                  total.quadtreeNodes, total.quadtreeDepth, total.collisionTests / frameCount);
+    text.getText().setString(buffer.data());
+
+    total = HudFrameStats{};
+    frames = 0;
+}
+
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <array>
 #include <memory>
 #include <string>
 #include <iostream> 
@@ -39,4 +40,41 @@ private:
     bool visibleState = true;
 };
 
+// what the performance HUD shows for one frame
+struct HudFrameStats {
+    float frameTime = 0.0f; // seconds
+    float simulationTime = 0.0f; 
+    float drawTime = 0.0f; 
+    size_t drawCalls = 0; 
+    size_t collisionTests = 0; 
+    size_t cloudBlue = 0; 
+    size_t cloudPurple = 0; 
+    size_t coins = 0; 
+    size_t quadtreeNodes = 0; 
+    size_t quadtreeDepth = 0; 
+};
+
+/* performance overlay drawn with a TextClass. frames are added up and the text is rewritten once every refreshTime seconds, with 
+times and per frame counts averaged over those frames. the text is formatted into a fixed buffer, so the HUD doesn't allocate 
+or touch the sf::Text in the frames it measures */
+class PerformanceHud : public sf::Drawable {
+public:
+    PerformanceHud(sf::Vector2f offset, unsigned int size, sf::Color color, std::weak_ptr<sf::Font> font, float refreshTime);
+
+    void addFrame(const HudFrameStats& stats); 
+    // true when adding a frame this long rewrites the text, so stats that are costly to gather are only worked out for that frame
+    bool needsRefresh(float frameTime) const { return total.frameTime + frameTime >= refreshTime; }
+    void setViewTopLeft(sf::Vector2f topLeft) { text.getText().setPosition(topLeft + offset); } // the HUD stays put on screen
 
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override { target.draw(text, states); }
+
+private:
+    void refresh(); 
+
+    TextClass text; 
+    sf::Vector2f offset {};
+    float refreshTime {}; 
+    HudFrameStats total {}; // since the last refresh; counts of live things hold the latest frame's
+    size_t frames = 0; 
+    std::array<char, 512> buffer {}; 
+};
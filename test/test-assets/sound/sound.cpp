@@ -17,10 +17,10 @@ SoundClass::SoundClass(std::weak_ptr<sf::SoundBuffer> soundBuffer, float volume)
         sound->setBuffer(*soundBuff);
         sound->setVolume(volume); 
 
-        log_info("Sound initialized successfully");
+        LOG_INFO(Assets, "Sound initialized successfully");
 
     } catch (const std::exception& e) {
-        log_error(e.what());  // Use spdlog to log the error
+        LOG_ERROR(Assets, "{}", e.what());  // Use spdlog to log the error
         soundBuffer.reset();
         sound.reset(); 
     }
@@ -36,9 +36,9 @@ MusicClass::MusicClass(std::unique_ptr<sf::Music> musicLoad, float volume)
         music->setVolume(volume);
         music->setLoop(true);  
 
-        log_info("Music initialized successfully, volume is " + std::to_string(volume)); 
+        LOG_INFO(Assets, "Music initialized successfully, volume is {}", volume); 
     } catch (const std::exception& e) {
-        log_error(e.what()); 
+        LOG_ERROR(Assets, "{}", e.what()); 
         music.reset();  
     }
 }
@@ -49,7 +49,7 @@ void SoundClass::setVolume(float newVolume) {
 
     if (sound) {
         sound->setVolume(volume); 
-        log_info("Sound volume set to " + std::to_string(volume));  // Log volume change
+        LOG_INFO(Assets, "Sound volume set to {}", volume);  // Log volume change
     }
 }
 
@@ -59,6 +59,6 @@ void MusicClass::setVolume(float newVolume) {
 
     if (music) {
         music->setVolume(volume); 
-        log_info("Music volume set to " + std::to_string(volume));  // Log volume change
+        LOG_INFO(Assets, "Music volume set to {}", volume);  // Log volume change
     }
 }
\ No newline at end of file
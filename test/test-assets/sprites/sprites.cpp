@@ -11,30 +11,32 @@ Sprite::Sprite(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Text
     : position(position), scale(scale), texture(texture), spriteCreated(std::make_unique<sf::Sprite>()), visibleState(true) {
     try {
         if (auto tex = texture.lock()) {  
-            sf::Vector2u textureSize = tex->getSize(); 
+            sf::Vector2u textureSize = Constants::textureSize(*tex); 
             if (!textureSize.x || !textureSize.y) {
                 throw std::runtime_error("Loaded texture has size 0");
             }
 
+            // the rect is set from the size so it's also right headless, where the texture itself is empty
             spriteCreated->setTexture(*tex); 
+            spriteCreated->setTextureRect(sf::IntRect(0, 0, textureSize.x, textureSize.y)); 
             spriteCreated->setPosition(position);
             spriteCreated->setScale(scale);
 
-            log_info("Sprite initialized successfully");
+            LOG_INFO(Sprites, "Sprite initialized successfully");
 
         } else {
             throw std::runtime_error("Texture is no longer available");
         }
     }
     catch (const std::exception& e) {
-        log_error(e.what());
+        LOG_ERROR(Sprites, "{}", e.what());
         visibleState = false;
     }
 }
 
 float Sprite::getRadius() const {
     if (!spriteCreated) {
-        log_warning("\tUnable to get sprite's radius because sprite doesn't exist");
+        LOG_WARNING(Sprites, "\tUnable to get sprite's radius because sprite doesn't exist");
         return 0.0f; 
     }
 
@@ -55,26 +57,29 @@ float Sprite::getRadius() const {
 // background class constructor; takes in position, scale, texture 
 Background::Background(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture) : Sprite(position, scale, texture) {
     if (auto tex = texture.lock()) {
-        spriteCreated = std::make_unique<sf::Sprite>(*tex);
+        sf::Vector2u textureSize = Constants::textureSize(*tex); 
+        sf::IntRect wholeTexture(0, 0, textureSize.x, textureSize.y); 
+
+        spriteCreated = std::make_unique<sf::Sprite>(*tex, wholeTexture);
         spriteCreated->setScale(scale);
         spriteCreated->setPosition(position.x, position.y); 
 
         // initially position background sprite2 to the right side (off screen)
-        spriteCreated2 = std::make_unique<sf::Sprite>(*tex);
+        spriteCreated2 = std::make_unique<sf::Sprite>(*tex, wholeTexture);
         spriteCreated2->setScale(scale);
-        spriteCreated2->setPosition(position.x + tex->getSize().x * scale.x, position.y);
+        spriteCreated2->setPosition(position.x + textureSize.x * scale.x, position.y);
 
         // initially position background sprite2 to the down side (off screen)
-        spriteCreated3 = std::make_unique<sf::Sprite>(*tex);
+        spriteCreated3 = std::make_unique<sf::Sprite>(*tex, wholeTexture);
         spriteCreated3->setScale(scale);
-        spriteCreated3->setPosition(position.x, position.y + tex->getSize().y * scale.y);
+        spriteCreated3->setPosition(position.x, position.y + textureSize.y * scale.y);
 
         // initially position background sprite2 to the down side (off screen)
-        spriteCreated4 = std::make_unique<sf::Sprite>(*tex);
+        spriteCreated4 = std::make_unique<sf::Sprite>(*tex, wholeTexture);
         spriteCreated4->setScale(scale);
         spriteCreated4->setPosition(position.x, position.y);
 
-        log_info("Background created");    
+        LOG_INFO(Sprites, "Background created");    
     }
 }
  
@@ -172,7 +177,7 @@ void Animated::setRects(int animNum){
         spriteCreated->setTextureRect(animationRects[animNum]);    
     }
     catch (const std::exception& e) {
-        log_error("Error in setting texture: " + std::string(e.what()) + " | Index Max: " + std::to_string(indexMax) + " | Current Index: " + std::to_string(animNum));
+        LOG_ERROR(Sprites, "Error in setting texture: {} | Index Max: {} | Current Index: {}", e.what(), indexMax, animNum);
     }
 }
 
@@ -191,14 +196,14 @@ void Animated::changeAnimation() {
         }
     }
     catch (const std::exception& e) {
-        log_error("Error in changing animation: " + std::string(e.what()) + " | Current Index: " + std::to_string(currentIndex));
+        LOG_ERROR(Sprites, "Error in changing animation: {} | Current Index: {}", e.what(), currentIndex);
     }
 }
 
 float Animated::getRadius() const {
     if (!spriteCreated) {
         return 0.0f;  
-        log_warning("\tUnable to get sprite's radius because sprite doesn't exist"); 
+        LOG_WARNING(Sprites, "\tUnable to get sprite's radius because sprite doesn't exist"); 
     }
     sf::IntRect rect = getRects();  // Retrieve the sf::IntRect for the sprite
     
@@ -220,12 +225,12 @@ void Sprite::updateVisibility() {
             position.y < 0 - Constants::SPRITE_OUT_OF_BOUNDS_OFFSET ||
             position.x < 0 - Constants::SPRITE_OUT_OF_BOUNDS_OFFSET) {
             setVisibleState(false);
-            log_info("Sprite moved out of bounds and is no longer visible.");
+            LOG_INFO(Sprites, "Sprite moved out of bounds and is no longer visible.");
         }
-        log_info("Sprite position updated to (" + std::to_string(position.x) + ", " + std::to_string(position.y) + ")");
+        LOG_INFO(Sprites, "Sprite position updated to ({}, {})", position.x, position.y);
     }
     catch (const std::exception& e) {
-        log_error("Error in updating position: " + std::string(e.what()));
+        LOG_ERROR(Sprites, "Error in updating position: {}", e.what());
     }
 }
 
@@ -238,7 +243,7 @@ sf::IntRect Animated::getRects() const {
         return animationRects[currentIndex % animationRects.size()];
     } 
     catch (const std::exception& e) {
-        log_error("Error in getRects: " + std::string(e.what()));
+        LOG_ERROR(Sprites, "Error in getRects: {}", e.what());
         throw;
     }
 }
@@ -253,7 +258,7 @@ std::shared_ptr<sf::Uint8[]> const Animated::getBitmask(size_t index) const {
         return bitMask[index].lock();
     } 
     catch (const std::exception& e) {
-        log_error("Error in getBitmask: " + std::string(e.what()) + " | Requested index: " + std::to_string(index));
+        LOG_ERROR(Sprites, "Error in getBitmask: {} | Requested index: {}", e.what(), index);
         throw;
     }
 }
@@ -264,7 +269,7 @@ std::shared_ptr<sf::Uint8[]> const Cloud::getBitmask(size_t index) const {
         return bitMask.lock();
     } 
     catch (const std::exception& e) {
-        log_error("Error in getBitmask for cloud: " + std::string(e.what()));
+        LOG_ERROR(Sprites, "Error in getBitmask for cloud: {}", e.what());
         throw;
     }
 }
@@ -275,7 +280,7 @@ std::shared_ptr<sf::Uint8[]> const Coin::getBitmask(size_t index) const {
         return bitMask.lock();
     } 
     catch (const std::exception& e) {
-        log_error("Error in getBitmask for coin: " + std::string(e.what()));
+        LOG_ERROR(Sprites, "Error in getBitmask for coin: {}", e.what());
         throw;
     }
 }
@@ -284,7 +289,7 @@ std::shared_ptr<sf::Uint8[]> const Coin::getBitmask(size_t index) const {
 void Player::updatePlayer(sf::Vector2f newPos) {
     changePosition(newPos); 
     updatePos();
-    log_info("Player position updated to (" + std::to_string(newPos.x) + ", " + std::to_string(newPos.y) + ")");
+    LOG_INFO(Sprites, "Player position updated to ({}, {})", newPos.x, newPos.y);
 }
 
 void Player::changeAnimation() {
@@ -314,7 +319,7 @@ void Player::changeAnimation() {
             }
         }
     } catch (const std::exception& e) {
-        log_error("Error in changing animation: " + std::string(e.what()) + " | Current Index: " + std::to_string(currentIndex));
+        LOG_ERROR(Sprites, "Error in changing animation: {} | Current Index: {}", e.what(), currentIndex);
     }
 }
 
@@ -323,7 +328,7 @@ void Obstacle::setDirectionVector(float angle) {
     float angleRad = angle * (3.14f / 180.f);
     directionVector.x = std::cos(angleRad);
     directionVector.y = std::sin(angleRad);
-    log_info("Obstacle direction vector set based on angle " + std::to_string(angle));
+    LOG_INFO(Sprites, "Obstacle direction vector set based on angle {}", angle);
 }
 
 // sets bullet's direction vector 
@@ -337,5 +342,5 @@ void Bullet::setDirectionVector(sf::Vector2i projectionPos) {
         directionVector.x /= length;
         directionVector.y /= length;
     }
-    log_info("Bullet direction vector calculated.");
+    LOG_INFO(Sprites, "Bullet direction vector calculated.");
 }
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <map>
+#include <vector>
 #include <SFML/Graphics.hpp>
 
 #include "../globals/globals.hpp"
@@ -57,7 +58,9 @@ protected:
 class Animated : public virtual Sprite {
 public:
     explicit Animated( sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, const std::vector<sf::IntRect> animationRects, unsigned const int indexMax,  const std::vector<std::weak_ptr<sf::Uint8[]>>& bitMask) 
-        : Sprite(position, scale, texture), animationRects(animationRects), indexMax(indexMax), bitMask(bitMask) {}
+        : Sprite(position, scale, texture), animationRects(animationRects), indexMax(indexMax), bitMask(bitMask) { 
+        if (!this->animationRects.empty()) spriteCreated->setTextureRect(this->animationRects[0]); // start on the first frame, not the whole (atlas) texture 
+    }
     std::vector<sf::IntRect> const getAnimationRects() const { return animationRects; } 
     void setAnimation(std::vector<sf::IntRect> AnimationRects) { animationRects = AnimationRects; } 
     
@@ -126,7 +129,7 @@ public:
 class NonStatic : public virtual Sprite{
 public:
    explicit NonStatic(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, float speed, sf::Vector2f acceleration)
-        : Sprite(position, scale, texture), speed(speed), acceleration(acceleration) {}
+        : Sprite(position, scale, texture), previousPosition(position), speed(speed), acceleration(acceleration) {}
     ~NonStatic() override{}; 
 
     bool getMoveState() const { return moveState; }
@@ -143,8 +146,13 @@ public:
     virtual sf::Vector2f getAcceleration() const override{ return acceleration; }
     virtual void updatePos() { spriteCreated->setPosition(position); }
 
+    // for fixed timestep rendering; remember where a step started and draw between that and the current position
+    void storePreviousPosition() { previousPosition = position; spriteCreated->setPosition(position); }
+    void interpolatePosition(float alpha) { spriteCreated->setPosition(previousPosition + (position - previousPosition) * alpha); }
+
 protected:
     bool moveState = true;
+    sf::Vector2f previousPosition{}; 
     sf::Vector2f directionVector{}; 
     float speed {}; 
     sf::Vector2f acceleration{}; 
@@ -152,8 +160,8 @@ protected:
 
 class Cloud : public NonStatic{
 public:
-    explicit Cloud(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, float speed, sf::Vector2f acceleration, std::weak_ptr<sf::Uint8[]>& bitMask)
-        : Sprite(position, scale, texture), NonStatic(position, scale, texture, speed, acceleration), bitMask(bitMask) {}
+    explicit Cloud(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, sf::IntRect textureRect, float speed, sf::Vector2f acceleration, std::weak_ptr<sf::Uint8[]>& bitMask)
+        : Sprite(position, scale, texture), NonStatic(position, scale, texture, speed, acceleration), bitMask(bitMask) { spriteCreated->setTextureRect(textureRect); }
     ~Cloud() override{}; 
 
     std::shared_ptr<sf::Uint8[]> const getBitmask(size_t index) const override;     
@@ -165,8 +173,8 @@ private:
 
 class Coin : public NonStatic{
 public:
-    explicit Coin(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, float speed, sf::Vector2f acceleration, std::weak_ptr<sf::Uint8[]>& bitMask)
-        : Sprite(position, scale, texture), NonStatic(position, scale, texture, speed, acceleration), bitMask(bitMask) {}
+    explicit Coin(sf::Vector2f position, sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, sf::IntRect textureRect, float speed, sf::Vector2f acceleration, std::weak_ptr<sf::Uint8[]>& bitMask)
+        : Sprite(position, scale, texture), NonStatic(position, scale, texture, speed, acceleration), bitMask(bitMask) { spriteCreated->setTextureRect(textureRect); }
     ~Coin() override{}; 
 
     std::shared_ptr<sf::Uint8[]> const getBitmask(size_t index) const override;     
@@ -8,7 +8,7 @@ Tile::Tile(sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, sf::IntRect t
         tileSprite = std::make_unique<sf::Sprite>(); // Use unique_ptr for tileSprite
 
         if (auto sharedTexture = texture.lock()) {
-            sf::Vector2u textureSize = sharedTexture->getSize(); 
+            sf::Vector2u textureSize = Constants::textureSize(*sharedTexture); 
             if (textureSize.x == 0 || textureSize.y == 0) {
                 throw std::runtime_error("Loaded texture has size 0");
             }
@@ -20,7 +20,7 @@ Tile::Tile(sf::Vector2f scale, std::weak_ptr<sf::Texture> texture, sf::IntRect t
             throw std::runtime_error("Tile texture is not available");
         }
     } catch (const std::exception& e) {
-        log_error(e.what()); // Log any exceptions that occur
+        LOG_ERROR(Tiles, "{}", e.what()); // Log any exceptions that occur
     }
 }
 
@@ -45,79 +45,513 @@ Tile::Tile(const Tile& other)
     }
 }
  
-TileMap::TileMap(std::shared_ptr<Tile>* tileTypesArray, unsigned int tileTypesNumber, size_t tileMapWidth, size_t tileMapHeight, float tileWidth, float tileHeight, std::filesystem::path filePath, sf::Vector2f tileMapPosition) 
-    : tileTypesNumber(tileTypesNumber), tileMapWidth(tileMapWidth), tileMapHeight(tileMapHeight), tileWidth(tileWidth), tileHeight(tileHeight), tileMapPosition(tileMapPosition) {
+TileMap::TileMap(std::shared_ptr<Tile>* tileTypesArray, unsigned int tileTypesNumber, size_t tileMapWidth, size_t tileMapHeight, float tileWidth, float tileHeight, std::filesystem::path filePath, sf::Vector2f tileMapPosition, size_t streamingBudget) 
+    : tileTypesNumber(tileTypesNumber), tileMapWidth(tileMapWidth), tileMapHeight(tileMapHeight), tileWidth(tileWidth), tileHeight(tileHeight), 
+      tileTypes(tileTypesArray, tileTypesArray + tileTypesNumber), tileMapPosition(tileMapPosition), streamingBudget(streamingBudget) {
 
     try{
-        tiles.reserve( tileMapWidth * tileMapHeight ); 
+        if (tileTypesNumber >= EMPTY_TILE) {
+            throw std::out_of_range("Too many tile types for 16 bit ids: " + std::to_string(tileTypesNumber));
+        }
 
-        std::ifstream fileStream(filePath);
-        
-        if (!fileStream.is_open()) {
-            throw std::runtime_error("Unable to open file: " + filePath.string());
+        if (streamingBudget > 0) {
+            streamer = std::make_unique<TileChunkStreamer>(filePath, tileMapWidth, tileMapHeight, CHUNK_SIZE, tileTypesNumber); 
+            this->tileMapWidth = streamer->getWidth(); 
+            this->tileMapHeight = streamer->getHeight(); 
+            if (streamer->getTileWidth() > 0.0f) this->tileWidth = streamer->getTileWidth(); 
+            if (streamer->getTileHeight() > 0.0f) this->tileHeight = streamer->getTileHeight(); 
         }
+        else if (filePath.extension() == BINARY_EXTENSION) loadBinary(filePath); 
+        else loadText(filePath); 
 
-        std::string line;
-        unsigned int currentY = 0; // Track the current row
+        LOG_INFO(Tiles, "Tile map initialized successfully");
+    } catch (const std::exception& e) {
+        LOG_WARNING(Tiles, "Error in making tilemap: {}", e.what());
+    }
 
-        while (std::getline(fileStream, line) && currentY < tileMapHeight) {
-            std::istringstream lineStream(line);
-            std::string tileIndexStr;
-            unsigned int currentX = 0; // Track the current column
+    if (!cellIds && !streamer) { // failed to load, start empty so addTile still works
+        tileIds.assign(this->tileMapWidth * this->tileMapHeight, EMPTY_TILE); 
+        cellIds = tileIds.data(); 
+    }
+    if (!tileTypes.empty() && tileTypes[0]) tileTexture = tileTypes[0]->getTileSprite().getTexture(); 
+    setupChunks(); 
+}
+
+void TileMap::loadText(const std::filesystem::path& filePath) {
+    tileIds = readTextFile(filePath, tileMapWidth, tileMapHeight, tileTypesNumber); 
+    cellIds = tileIds.data(); 
+}
+
+// maps the file and reads the ids in place; ids without a prototype just show up as empty cells (see getTile) 
+void TileMap::loadBinary(const std::filesystem::path& filePath) {
+    const std::uint16_t endianCheck = 1; 
+    if (*reinterpret_cast<const unsigned char*>(&endianCheck) != 1) {
+        throw std::runtime_error("Binary tile maps are little endian, use the text map on this machine");
+    }
 
-            while (lineStream >> tileIndexStr && currentX < tileMapWidth) {
-                unsigned int tileIndex = std::stoul(tileIndexStr); // Convert to unsigned int
-                
-                if (tileIndex < tileTypesNumber) {
-                    auto tile = tileTypesArray[tileIndex]->clone();
-                    tile->getTileSprite().setPosition(tileMapPosition.x + currentX * tileWidth, tileMapPosition.y + currentY * tileHeight); 
-                    tiles.emplace_back(std::move(tile));
-                    
-                } else {
-                    throw std::out_of_range("Tile index out of bounds: " + std::to_string(tileIndex));
-                }
-                currentX++; // Increment column index
-            } 
-            currentY++; // Increment row index
+    auto file = std::make_shared<utils::MappedFile>(filePath); 
+    if (!*file) {
+        throw std::runtime_error("Unable to map file: " + filePath.string());
+    }
+    if (file->size() < sizeof(TileMapFileHeader)) {
+        throw std::runtime_error("Tile map file too small for a header: " + filePath.string());
+    }
+
+    TileMapFileHeader header; 
+    std::memcpy(&header, file->data(), sizeof(header)); 
+    if (std::memcmp(header.magic, "TMAP", 4) != 0 || header.version != FILE_VERSION) {
+        throw std::runtime_error("Not a version " + std::to_string(FILE_VERSION) + " tile map file: " + filePath.string());
+    }
+
+    size_t cellCount = static_cast<size_t>(header.width) * header.height; 
+    if (file->size() < sizeof(header) + cellCount * sizeof(std::uint16_t)) {
+        throw std::runtime_error("Tile map file is truncated: " + filePath.string());
+    }
+
+    if (header.width != tileMapWidth || header.height != tileMapHeight || header.tileWidth != tileWidth || header.tileHeight != tileHeight) {
+        LOG_WARNING(Tiles, "Tile map file size differs from the config, using the file's: {}", filePath.string());
+        tileMapWidth = header.width; 
+        tileMapHeight = header.height; 
+        tileWidth = header.tileWidth; 
+        tileHeight = header.tileHeight; 
+    }
+
+    mappedFile = std::move(file); 
+    cellIds = reinterpret_cast<const std::uint16_t*>(mappedFile->data() + sizeof(header)); 
+}
+
+/* readTextFile parses rows of space separated ids. the whole file is read at once and parsed with from_chars, so there are no 
+per token streams or string copies */
+std::vector<std::uint16_t> TileMap::readTextFile(const std::filesystem::path& filePath, size_t width, size_t height, unsigned int tileTypesNumber) {
+    std::ifstream fileStream(filePath, std::ios::binary);
+    if (!fileStream.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filePath.string());
+    }
+
+    std::string text(static_cast<size_t>(std::filesystem::file_size(filePath)), '\0'); 
+    fileStream.read(text.data(), static_cast<std::streamsize>(text.size())); 
+    fileStream.close();
+
+    std::vector<std::uint16_t> ids(width * height, EMPTY_TILE); 
+    const char* cursor = text.data(); 
+    const char* end = cursor + text.size(); 
+    size_t currentX = 0; // Track the current column
+    size_t currentY = 0; // Track the current row
+
+    while (cursor < end && currentY < height) {
+        if (*cursor == '\n') {
+            ++currentY; 
+            currentX = 0; 
+            ++cursor; 
+            continue; 
+        }
+        if (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+            ++cursor; 
+            continue; 
         }
 
-        fileStream.close();
+        unsigned int tileIndex = 0; 
+        auto [next, error] = std::from_chars(cursor, end, tileIndex); 
+        if (error != std::errc()) {
+            throw std::runtime_error("Bad tile index in row " + std::to_string(currentY) + " of " + filePath.string());
+        }
+        cursor = next; 
 
-        log_info("Tile map initialized successfully");
-    } catch (const std::exception& e) {
-        log_warning("Error in making tilemap: " + std::string(e.what()));
+        if (currentX >= width) continue; // extra columns are ignored 
+        if (tileIndex >= tileTypesNumber) {
+            throw std::out_of_range("Tile index out of bounds: " + std::to_string(tileIndex));
+        }
+        ids[currentY * width + currentX++] = static_cast<std::uint16_t>(tileIndex); 
+    }
+    return ids; 
+}
+
+void TileMap::writeBinaryFile(const std::filesystem::path& filePath, const std::vector<std::uint16_t>& ids, size_t width, size_t height, float tileWidth, float tileHeight) {
+    if (ids.size() != width * height) {
+        throw std::invalid_argument("Tile id count doesn't match the map size");
+    }
+
+    std::ofstream fileStream(filePath, std::ios::binary); 
+    if (!fileStream.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filePath.string());
+    }
+
+    TileMapFileHeader header { {'T', 'M', 'A', 'P'}, FILE_VERSION, static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), tileWidth, tileHeight }; 
+    fileStream.write(reinterpret_cast<const char*>(&header), sizeof(header)); 
+    fileStream.write(reinterpret_cast<const char*>(ids.data()), static_cast<std::streamsize>(ids.size() * sizeof(std::uint16_t))); 
+    if (!fileStream) {
+        throw std::runtime_error("Failed writing tile map file: " + filePath.string());
     }
 }
 
+void TileMap::convertTextToBinary(const std::filesystem::path& textPath, const std::filesystem::path& binaryPath, size_t width, size_t height, 
+                                  float tileWidth, float tileHeight, unsigned int tileTypesNumber) {
+    writeBinaryFile(binaryPath, readTextFile(textPath, width, height, tileTypesNumber), width, height, tileWidth, tileHeight); 
+    LOG_INFO(Tiles, "Converted {} to {}", textPath.string(), binaryPath.string()); 
+}
+
+const Tile* TileMap::getTile(unsigned int x, unsigned int y) const {
+    std::uint16_t tileType = getTileType(x, y); 
+    return tileType < tileTypes.size() ? tileTypes[tileType].get() : nullptr; 
+}
+
+// maps a world rectangle to the grid cells it covers; a cell [x, x + tileWidth) overlaps when the edges strictly cross, same as boundingBoxCollision 
+std::vector<TileCell> TileMap::queryTiles(const sf::FloatRect& area, TileFilter filter) const {
+    std::vector<TileCell> result; 
+    if (tileWidth <= 0.0f || tileHeight <= 0.0f || area.width <= 0.0f || area.height <= 0.0f) return result; 
+
+    float firstCellX = std::floor((area.left - tileMapPosition.x) / tileWidth); 
+    float firstCellY = std::floor((area.top - tileMapPosition.y) / tileHeight); 
+    float lastCellX = std::ceil((area.left + area.width - tileMapPosition.x) / tileWidth) - 1.0f; 
+    float lastCellY = std::ceil((area.top + area.height - tileMapPosition.y) / tileHeight) - 1.0f; 
+    if (lastCellX < 0.0f || lastCellY < 0.0f || firstCellX >= tileMapWidth || firstCellY >= tileMapHeight) return result; 
+
+    unsigned int startX = static_cast<unsigned int>(std::max(firstCellX, 0.0f)); 
+    unsigned int startY = static_cast<unsigned int>(std::max(firstCellY, 0.0f)); 
+    unsigned int endX = static_cast<unsigned int>(std::min(lastCellX, static_cast<float>(tileMapWidth - 1))); 
+    unsigned int endY = static_cast<unsigned int>(std::min(lastCellY, static_cast<float>(tileMapHeight - 1))); 
+
+    for (unsigned int y = startY; y <= endY; ++y) {
+        for (unsigned int x = startX; x <= endX; ++x) {
+            const Tile* tile = getTile(x, y); 
+            if (!tile) continue; 
+            if (filter == TileFilter::Walkable && !tile->getWalkable()) continue; 
+            if (filter == TileFilter::Solid && tile->getWalkable()) continue; 
+
+            result.push_back({ x, y, sf::Vector2f(tileMapPosition.x + x * tileWidth, tileMapPosition.y + y * tileHeight), tile }); 
+        }
+    }
+    return result; 
+}
+
+void TileMap::setupChunks() {
+    chunksX = (tileMapWidth + CHUNK_SIZE - 1) / CHUNK_SIZE; 
+    chunksY = (tileMapHeight + CHUNK_SIZE - 1) / CHUNK_SIZE; 
+    chunks.assign(chunksX * chunksY, TileChunk()); 
+}
+
+void TileMap::rebuildChunk(size_t chunkX, size_t chunkY) const {
+    TileChunk& chunk = chunks[chunkY * chunksX + chunkX]; 
+
+    size_t startX = chunkX * CHUNK_SIZE; 
+    size_t startY = chunkY * CHUNK_SIZE; 
+    size_t endX = std::min(startX + CHUNK_SIZE, tileMapWidth); 
+    size_t endY = std::min(startY + CHUNK_SIZE, tileMapHeight); 
+
+    chunk.vertices.resize((endX - startX) * (endY - startY) * 4); 
+    size_t quadCount = 0; 
+    for (size_t y = startY; y < endY; ++y) {
+        for (size_t x = startX; x < endX; ++x) {
+            const Tile* tile = getTile(x, y); 
+            if (!tile) continue; 
+
+            // the prototype's quad, moved from wherever the prototype sits to this cell 
+            const sf::Sprite& tileSprite = tile->getTileSprite(); 
+            sf::Vector2f offset = sf::Vector2f(tileMapPosition.x + x * tileWidth, tileMapPosition.y + y * tileHeight) - tileSprite.getPosition(); 
+            sf::Vertex* quad = &chunk.vertices[quadCount * 4]; 
+            writeSpriteQuad(quad, tileSprite); 
+            for (int i = 0; i < 4; ++i) quad[i].position += offset; 
+            ++quadCount; 
+        }
+    }
+    chunk.vertices.resize(quadCount * 4); 
+    chunk.dirty = false; 
+}
+
+// draws only the chunks that overlap the target's view, one draw call each 
 void TileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    for (const auto& tile : tiles) {
-        if (tile) {
-            target.draw(tile->getTileSprite(), states);
+    chunksDrawn = 0; 
+    if (chunks.empty() || tileWidth <= 0.0f || tileHeight <= 0.0f) return; 
+
+    const sf::View& view = target.getView(); 
+    sf::Vector2f viewMin = view.getCenter() - view.getSize() / 2.0f - tileMapPosition; 
+    sf::Vector2f viewMax = view.getCenter() + view.getSize() / 2.0f - tileMapPosition; 
+
+    // one cell of padding catches tiles drawn bigger than their grid cell 
+    float firstCellX = std::floor(viewMin.x / tileWidth) - 1.0f; 
+    float firstCellY = std::floor(viewMin.y / tileHeight) - 1.0f; 
+    float lastCellX = std::floor(viewMax.x / tileWidth) + 1.0f; 
+    float lastCellY = std::floor(viewMax.y / tileHeight) + 1.0f; 
+    if (lastCellX < 0.0f || lastCellY < 0.0f || firstCellX >= tileMapWidth || firstCellY >= tileMapHeight) return; 
+
+    size_t firstChunkX = static_cast<size_t>(std::max(firstCellX, 0.0f)) / CHUNK_SIZE; 
+    size_t firstChunkY = static_cast<size_t>(std::max(firstCellY, 0.0f)) / CHUNK_SIZE; 
+    size_t lastChunkX = std::min(static_cast<size_t>(lastCellX) / CHUNK_SIZE, chunksX - 1); 
+    size_t lastChunkY = std::min(static_cast<size_t>(lastCellY) / CHUNK_SIZE, chunksY - 1); 
+
+    states.texture = tileTexture; 
+    for (size_t chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (size_t chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            if (streamer && chunks[chunkY * chunksX + chunkX].state != ChunkState::Resident) continue; // still loading
+            if (chunks[chunkY * chunksX + chunkX].dirty) rebuildChunk(chunkX, chunkY); 
+
+            const sf::VertexArray& vertices = chunks[chunkY * chunksX + chunkX].vertices; 
+            if (vertices.getVertexCount() == 0) continue; 
+            target.draw(vertices, states); 
+            ++chunksDrawn; 
         }
     }
 }
 
-// Add a tile to the map at the specified grid position (x, y)
-void TileMap::addTile(unsigned int x, unsigned int y, std::unique_ptr<Tile> tile) {
+// Set the tile type at the specified grid position (x, y)
+void TileMap::addTile(unsigned int x, unsigned int y, std::uint16_t tileType) {
     try{
         if (x >= tileMapWidth || y >= tileMapHeight) {
             throw std::out_of_range("Tile position out of bounds: (" + std::to_string(x) + ", " + std::to_string(y) + ")");
         }
+        if (tileType != EMPTY_TILE && (tileType >= tileTypes.size() || !tileTypes[tileType])) {
+            throw std::out_of_range("Tile type has no prototype: " + std::to_string(tileType));
+        }
 
-        // Calculate the index in the tiles vector
-        unsigned int index = y * tileMapWidth + x;
+        if (streamer) {
+            TileChunk& chunk = chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE]; 
+            if (chunk.state != ChunkState::Resident) {
+                throw std::runtime_error("Tile chunk isn't loaded: (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+            }
+            chunk.ids[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] = tileType; 
+            chunk.dirty = true; 
+            return; 
+        }
+        if (cellIds != tileIds.data()) { // copy a mapped map out before the first write
+            tileIds.assign(cellIds, cellIds + tileMapWidth * tileMapHeight); 
+            cellIds = tileIds.data(); 
+            mappedFile.reset(); 
+        }
+        tileIds[y * tileMapWidth + x] = tileType; 
+        chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE].dirty = true; 
+    } catch (const std::exception& e) {
+        LOG_ERROR(Tiles, "{}", e.what()); // Log any exceptions that occur
+    }
+}
+
+std::uint16_t TileMap::streamedTileType(unsigned int x, unsigned int y) const {
+    const TileChunk& chunk = chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE]; 
+    if (chunk.state != ChunkState::Resident) return EMPTY_TILE; 
+    return chunk.ids[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE]; 
+}
+
+size_t TileMap::chunkBytes(const TileChunk& chunk) const {
+    return chunk.ids.capacity() * sizeof(std::uint16_t) + chunk.vertices.getVertexCount() * sizeof(sf::Vertex); 
+}
+
+void TileMap::evictChunk(size_t chunkIndex) {
+    TileChunk& chunk = chunks[chunkIndex]; 
+    residentChunks.erase(chunk.lruPosition); 
+    chunk.ids = std::vector<std::uint16_t>(); // release the memory, clear() would keep it
+    chunk.vertices = sf::VertexArray(sf::Quads); 
+    chunk.state = ChunkState::Unloaded; 
+    chunk.dirty = true; 
+}
+
+void TileMap::updateStreaming(const sf::FloatRect& area) {
+    if (!streamer || chunks.empty()) return; 
 
-        // Ensure the tile is valid (not nullptr)
-        if (!tile) {
-            throw std::runtime_error("Attempted to add a null tile.");
+    // hand over finished chunks; if the worker is mid hand-over they're picked up next step
+    if (streamer->tryTakeLoaded(loadedChunks)) {
+        for (auto& loadedChunk : loadedChunks) {
+            size_t chunkIndex = loadedChunk.chunkY * chunksX + loadedChunk.chunkX; 
+            TileChunk& chunk = chunks[chunkIndex]; 
+            if (chunk.state != ChunkState::Requested) continue; 
+
+            chunk.ids = std::move(loadedChunk.ids); 
+            chunk.state = ChunkState::Resident; 
+            chunk.dirty = true; 
+            residentChunks.push_back(chunkIndex); // coldest until touched below, so chunks the view already left go first
+            chunk.lruPosition = std::prev(residentChunks.end()); 
+        }
+        loadedChunks.clear(); 
+    }
+
+    // chunks under area plus a margin are wanted: touch the resident ones, request the rest
+    auto chunkRange = [](float start, float cellSize, size_t chunkCount) {
+        float chunk = std::floor(start / (cellSize * CHUNK_SIZE)); 
+        return static_cast<size_t>(std::clamp(chunk, 0.0f, static_cast<float>(chunkCount - 1))); 
+    };
+    size_t firstChunkX = chunkRange(area.left - tileMapPosition.x, tileWidth, chunksX); 
+    size_t firstChunkY = chunkRange(area.top - tileMapPosition.y, tileHeight, chunksY); 
+    size_t lastChunkX = chunkRange(area.left + area.width - tileMapPosition.x, tileWidth, chunksX); 
+    size_t lastChunkY = chunkRange(area.top + area.height - tileMapPosition.y, tileHeight, chunksY); 
+    firstChunkX = firstChunkX > STREAMING_MARGIN ? firstChunkX - STREAMING_MARGIN : 0; 
+    firstChunkY = firstChunkY > STREAMING_MARGIN ? firstChunkY - STREAMING_MARGIN : 0; 
+    lastChunkX = std::min(lastChunkX + STREAMING_MARGIN, chunksX - 1); 
+    lastChunkY = std::min(lastChunkY + STREAMING_MARGIN, chunksY - 1); 
+
+    for (size_t chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (size_t chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            size_t chunkIndex = chunkY * chunksX + chunkX; 
+            TileChunk& chunk = chunks[chunkIndex]; 
+            if (chunk.state == ChunkState::Resident) {
+                residentChunks.splice(residentChunks.begin(), residentChunks, chunk.lruPosition); 
+            } else if (chunk.state == ChunkState::Unloaded) {
+                chunk.state = ChunkState::Requested; 
+                streamer->request(chunkX, chunkY); 
+            }
         }
+    }
+
+    // evict from the cold end, but never a wanted chunk; those were all just moved to the front
+    size_t residentBytes = 0; 
+    for (size_t chunkIndex : residentChunks) residentBytes += chunkBytes(chunks[chunkIndex]); 
 
-        // Move the tile into the tiles vector at the calculated index
-        tiles[index] = std::move(tile);
+    while (residentBytes > streamingBudget && !residentChunks.empty()) {
+        size_t chunkIndex = residentChunks.back(); 
+        size_t chunkX = chunkIndex % chunksX; 
+        size_t chunkY = chunkIndex / chunksX; 
+        if (chunkX >= firstChunkX && chunkX <= lastChunkX && chunkY >= firstChunkY && chunkY <= lastChunkY) break; 
 
-        // Optionally set the position of the tile if the Tile class has a method for that
-        tiles[index]->getTileSprite().setPosition(tileMapPosition.x + x * tileWidth, tileMapPosition.y + y * tileHeight);
+        residentBytes -= chunkBytes(chunks[chunkIndex]); 
+        evictChunk(chunkIndex); 
+    }
+}
+
+TileChunkStreamer::TileChunkStreamer(const std::filesystem::path& filePath, size_t width, size_t height, size_t chunkSize, unsigned int tileTypesNumber)
+    : filePath(filePath), width(width), height(height), chunkSize(chunkSize), tileTypesNumber(tileTypesNumber) {
+
+    if (filePath.extension() == TileMap::BINARY_EXTENSION) {
+        mappedFile = std::make_unique<utils::MappedFile>(filePath); 
+        TileMapFileHeader header; 
+        if (!*mappedFile || mappedFile->size() < sizeof(header)) {
+            throw std::runtime_error("Unable to map file: " + filePath.string());
+        }
+        std::memcpy(&header, mappedFile->data(), sizeof(header)); 
+        if (std::memcmp(header.magic, "TMAP", 4) != 0 || header.version != TileMap::FILE_VERSION) {
+            throw std::runtime_error("Not a version " + std::to_string(TileMap::FILE_VERSION) + " tile map file: " + filePath.string());
+        }
+        if (mappedFile->size() < sizeof(header) + static_cast<size_t>(header.width) * header.height * sizeof(std::uint16_t)) {
+            throw std::runtime_error("Tile map file is truncated: " + filePath.string());
+        }
+        this->width = header.width; 
+        this->height = header.height; 
+        tileWidth = header.tileWidth; 
+        tileHeight = header.tileHeight; 
+    } else if (!std::filesystem::exists(filePath)) {
+        throw std::runtime_error("Unable to open file: " + filePath.string());
+    }
+
+    worker = std::thread(&TileChunkStreamer::run, this); 
+}
+
+TileChunkStreamer::~TileChunkStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(requestMutex); 
+        stopping = true; 
+    }
+    requestReady.notify_all(); 
+    if (worker.joinable()) worker.join(); 
+}
+
+void TileChunkStreamer::request(size_t chunkX, size_t chunkY) {
+    {
+        std::lock_guard<std::mutex> lock(requestMutex); 
+        requests.emplace_back(chunkX, chunkY); 
+    }
+    requestReady.notify_one(); 
+}
+
+bool TileChunkStreamer::tryTakeLoaded(std::vector<LoadedChunk>& result) {
+    std::unique_lock<std::mutex> lock(loadedMutex, std::try_to_lock); 
+    if (!lock.owns_lock()) return false; 
+
+    for (auto& chunk : loaded) result.push_back(std::move(chunk)); 
+    loaded.clear(); 
+    return true; 
+}
+
+void TileChunkStreamer::run() {
+    try {
+        if (!mappedFile) buildRowIndex(); 
     } catch (const std::exception& e) {
-        log_error(e.what()); // Log any exceptions that occur
+        LOG_ERROR(Tiles, "Exception indexing tile map rows: {}", e.what()); 
+    }
+
+    while (true) {
+        std::pair<size_t, size_t> chunkPosition; 
+        {
+            std::unique_lock<std::mutex> lock(requestMutex); 
+            requestReady.wait(lock, [this] { return stopping || !requests.empty(); }); 
+            if (stopping) return; 
+            chunkPosition = requests.front(); 
+            requests.pop_front(); 
+        }
+
+        LoadedChunk chunk { chunkPosition.first, chunkPosition.second, {} }; 
+        try {
+            chunk.ids = loadChunk(chunk.chunkX, chunk.chunkY); 
+        } catch (const std::exception& e) {
+            LOG_ERROR(Tiles, "Exception loading tile chunk: {}", e.what()); 
+            chunk.ids.assign(chunkSize * chunkSize, TileMap::EMPTY_TILE); // hand it over empty so it isn't requested forever
+        }
+
+        std::lock_guard<std::mutex> lock(loadedMutex); 
+        loaded.push_back(std::move(chunk)); 
+    }
+}
+
+// one pass over the file recording where each row starts, so a chunk only reads its own rows 
+void TileChunkStreamer::buildRowIndex() {
+    std::ifstream fileStream(filePath, std::ios::binary); 
+    if (!fileStream.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filePath.string());
+    }
+
+    rowOffsets.reserve(height); 
+    rowOffsets.push_back(0); 
+    std::vector<char> buffer(1 << 16); 
+    std::streamoff blockStart = 0; 
+    while (rowOffsets.size() < height && fileStream) {
+        fileStream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())); 
+        std::streamsize readCount = fileStream.gcount(); 
+        for (std::streamsize i = 0; i < readCount && rowOffsets.size() < height; ++i) {
+            if (buffer[i] == '\n') rowOffsets.push_back(blockStart + i + 1); 
+        }
+        blockStart += readCount; 
+    }
+}
+
+std::vector<std::uint16_t> TileChunkStreamer::loadChunk(size_t chunkX, size_t chunkY) {
+    std::vector<std::uint16_t> ids(chunkSize * chunkSize, TileMap::EMPTY_TILE); 
+    size_t startX = chunkX * chunkSize; 
+    size_t startY = chunkY * chunkSize; 
+    size_t endX = std::min(startX + chunkSize, width); 
+    size_t endY = std::min(startY + chunkSize, height); 
+
+    if (mappedFile) {
+        const unsigned char* cells = mappedFile->data() + sizeof(TileMapFileHeader); 
+        for (size_t y = startY; y < endY; ++y) {
+            std::memcpy(&ids[(y - startY) * chunkSize], cells + (y * width + startX) * sizeof(std::uint16_t), (endX - startX) * sizeof(std::uint16_t)); 
+        }
+        return ids; 
+    }
+
+    std::ifstream fileStream(filePath, std::ios::binary); 
+    if (!fileStream.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filePath.string());
+    }
+
+    std::string line; 
+    for (size_t y = startY; y < endY && y < rowOffsets.size(); ++y) {
+        fileStream.clear(); 
+        fileStream.seekg(rowOffsets[y]); 
+        if (!std::getline(fileStream, line)) break; 
+
+        const char* cursor = line.data(); 
+        const char* end = cursor + line.size(); 
+        for (size_t x = 0; x < endX && cursor < end; ) {
+            if (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+                ++cursor; 
+                continue; 
+            }
+
+            unsigned int tileIndex = 0; 
+            auto [next, error] = std::from_chars(cursor, end, tileIndex); 
+            if (error != std::errc()) {
+                throw std::runtime_error("Bad tile index in row " + std::to_string(y) + " of " + filePath.string());
+            }
+            cursor = next; 
+
+            if (x >= startX) ids[(y - startY) * chunkSize + (x - startX)] = tileIndex < tileTypesNumber ? static_cast<std::uint16_t>(tileIndex) : TileMap::EMPTY_TILE; 
+            ++x; 
+        }
     }
+    return ids; 
 }
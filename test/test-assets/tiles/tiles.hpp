@@ -8,11 +8,25 @@
 #include <stdio.h>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include <SFML/Graphics.hpp>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <charconv>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <filesystem>
 
 #include "../../test-logging/log.hpp"
+#include "../../test-src/game/camera/window.hpp"
+#include "../../test-src/game/globals/globals.hpp"
+#include "../../test-src/game/utils/utils.hpp"
 
 
 class Tile {
@@ -23,6 +37,7 @@ public:
     sf::Sprite& getTileSprite() const { return *tileSprite; } 
 
     sf::IntRect const getTextureRect() const { return textureRect; }
+    sf::Vector2f const getScale() const { return scale; }
     std::weak_ptr<sf::Uint8[]>  const getBitMask() const { return bitmask; }
  
     bool getWalkable() const { return walkable; }
@@ -45,14 +60,94 @@ private:
     bool walkable {};
 };
 
+/* binary tile map file (.tmb): this header followed by width * height little endian uint16 tile ids, row major. the ids 
+start 24 bytes in, so a mapped file can be read in place */
+struct TileMapFileHeader {
+    char magic[4]; // "TMAP"
+    std::uint32_t version; 
+    std::uint32_t width; 
+    std::uint32_t height; 
+    float tileWidth; 
+    float tileHeight; 
+};
+static_assert(sizeof(TileMapFileHeader) == 24, "tile map header must stay packed");
+
+// one occupied grid cell returned by TileMap::queryTiles
+struct TileCell {
+    unsigned int x {}; 
+    unsigned int y {}; 
+    sf::Vector2f position {}; // world position of the cell's top left corner
+    const Tile* tile = nullptr; 
+};
+
+enum class TileFilter { All, Walkable, Solid }; // solid means not walkable 
+
+/* TileChunkStreamer loads chunks of tile ids from a tile map file (text or binary) on a background thread. The main thread 
+queues requests and picks up finished chunks with tryTakeLoaded, which never waits on the worker */
+class TileChunkStreamer {
+public:
+    struct LoadedChunk {
+        size_t chunkX {}; 
+        size_t chunkY {}; 
+        std::vector<std::uint16_t> ids; // chunkSize * chunkSize, cells past the map edge are EMPTY_TILE
+    };
+
+    TileChunkStreamer(const std::filesystem::path& filePath, size_t width, size_t height, size_t chunkSize, unsigned int tileTypesNumber); 
+    ~TileChunkStreamer(); 
+    TileChunkStreamer(const TileChunkStreamer&) = delete; 
+    TileChunkStreamer& operator=(const TileChunkStreamer&) = delete; 
+
+    // binary files carry their own size in the header, text files use the size passed in 
+    size_t getWidth() const { return width; } 
+    size_t getHeight() const { return height; } 
+    float getTileWidth() const { return tileWidth; } // 0 for text files
+    float getTileHeight() const { return tileHeight; } 
+
+    void request(size_t chunkX, size_t chunkY); 
+    bool tryTakeLoaded(std::vector<LoadedChunk>& result); // appends finished chunks; false if the worker was busy handing one over
+
+private:
+    void run(); 
+    void buildRowIndex(); 
+    std::vector<std::uint16_t> loadChunk(size_t chunkX, size_t chunkY); 
+
+    std::filesystem::path filePath; 
+    size_t width {}; 
+    size_t height {}; 
+    size_t chunkSize {}; 
+    unsigned int tileTypesNumber {}; 
+    float tileWidth {}; 
+    float tileHeight {}; 
+
+    std::unique_ptr<utils::MappedFile> mappedFile; // binary files, only the pages of loaded chunks get read
+    std::vector<std::streamoff> rowOffsets; // text files, where each row starts; built by the worker before its first load 
+
+    std::deque<std::pair<size_t, size_t>> requests; 
+    std::mutex requestMutex; 
+    std::condition_variable requestReady; 
+    bool stopping = false; 
+
+    std::vector<LoadedChunk> loaded; 
+    std::mutex loadedMutex; 
+
+    std::thread worker; // declared last so it starts after everything above is set up
+};
+
+/* TileMap stores one tile-type id per cell and shares a Tile prototype per type (flyweight), so a cell costs two bytes; 
+positions come from the grid coordinates */
 class TileMap : public sf::Drawable {
 public:
-    // Constructor now accepts a shared_ptr to a default tile, and initializes the map with it
-    explicit TileMap(std::shared_ptr<Tile>* tileTypesArray, unsigned int tileTypesNumber, size_t tileMapWidth, size_t tileMapHeight, float tileWidth, float tileHeight, std::filesystem::path filePath, sf::Vector2f tileMapPosition);
+    // Constructor takes the tile prototypes and fills the map with their ids from the file 
+    // a non-zero streamingBudget (bytes) streams chunks around the view instead of loading the whole file, see updateStreaming
+    explicit TileMap(std::shared_ptr<Tile>* tileTypesArray, unsigned int tileTypesNumber, size_t tileMapWidth, size_t tileMapHeight, float tileWidth, float tileHeight, std::filesystem::path filePath, sf::Vector2f tileMapPosition, size_t streamingBudget = 0);
     ~TileMap() = default;
     
-    // Add a tile to the map at the specified grid position (x, y)
-    void addTile(unsigned int x, unsigned int y, std::unique_ptr<Tile> tile); 
+    // Set the tile type at the specified grid position (x, y); EMPTY_TILE clears the cell. 
+    // when streaming only resident chunks can be edited, and the edit is gone once the chunk is evicted
+    void addTile(unsigned int x, unsigned int y, std::uint16_t tileType); 
+    std::uint16_t getTileType(unsigned int x, unsigned int y) const { return cellIds ? cellIds[y * tileMapWidth + x] : streamedTileType(x, y); } 
+    const Tile* getTile(unsigned int x, unsigned int y) const; // prototype for the cell, nullptr if empty 
+    std::vector<TileCell> queryTiles(const sf::FloatRect& area, TileFilter filter = TileFilter::All) const; // only visits the cells under area
     float const getTileWidth() const { return tileWidth; }
     float const getTileHeight() const { return tileHeight; }
     size_t const getTileMapWidth() const { return tileMapWidth; }
@@ -61,6 +156,24 @@ public:
     unsigned int const getTileTypesNumber() const { return tileTypesNumber; }
     bool const getVisibleState() const { return visibleState; }
     void setVisibleState(bool newVisibleState) { visibleState = newVisibleState; }
+    size_t getChunksDrawn() const { return chunksDrawn; } // chunks that were on screen in the last draw
+    size_t getResidentChunks() const { return residentChunks.size(); } // streaming only
+
+    // streaming only: installs chunks the loader finished, requests the ones around area and evicts the least recently used 
+    // chunks over the memory budget. call once per step from the main thread 
+    void updateStreaming(const sf::FloatRect& area); 
+
+    static constexpr size_t CHUNK_SIZE = 32; // chunks are CHUNK_SIZE x CHUNK_SIZE cells
+    static constexpr std::uint16_t EMPTY_TILE = 0xFFFF; 
+    static constexpr std::uint32_t FILE_VERSION = 1; 
+    static constexpr const char* BINARY_EXTENSION = ".tmb"; // any other extension is read as text
+    static constexpr size_t STREAMING_MARGIN = 1; // chunks kept loaded around the ones under the streaming area
+
+    // file helpers, also used by the converter and Constants::writeRandomTileMap
+    static std::vector<std::uint16_t> readTextFile(const std::filesystem::path& filePath, size_t width, size_t height, unsigned int tileTypesNumber); 
+    static void writeBinaryFile(const std::filesystem::path& filePath, const std::vector<std::uint16_t>& ids, size_t width, size_t height, float tileWidth, float tileHeight); 
+    static void convertTextToBinary(const std::filesystem::path& textPath, const std::filesystem::path& binaryPath, size_t width, size_t height, 
+                                    float tileWidth, float tileHeight, unsigned int tileTypesNumber); 
 
 private:
     unsigned int tileTypesNumber {};
@@ -70,10 +183,43 @@ private:
     float tileWidth {};
     float tileHeight {};
 
-    std::vector<std::unique_ptr<Tile>> tiles; 
+    std::vector<std::shared_ptr<Tile>> tileTypes; // shared prototypes, indexed by tile id
+    std::vector<std::uint16_t> tileIds; // owned ids: text maps, or a binary map after its first addTile 
+    std::shared_ptr<utils::MappedFile> mappedFile; // binary maps are read in place from here
+    const std::uint16_t* cellIds = nullptr; // row major, tileMapWidth * tileMapHeight; points into tileIds or mappedFile
     sf::Vector2f tileMapPosition; 
     bool visibleState = true;
 
+    // each chunk bakes its tiles into one vertex array, rebuilt on the next draw after addTile touches it 
+    enum class ChunkState { Unloaded, Requested, Resident }; 
+    struct TileChunk {
+        sf::VertexArray vertices { sf::Quads }; 
+        bool dirty = true; 
+        // streaming only
+        ChunkState state = ChunkState::Unloaded; 
+        std::vector<std::uint16_t> ids; // CHUNK_SIZE * CHUNK_SIZE while resident
+        std::list<size_t>::iterator lruPosition; 
+    };
+    mutable std::vector<TileChunk> chunks; // row major, chunksX * chunksY 
+    size_t chunksX {}; 
+    size_t chunksY {}; 
+    const sf::Texture* tileTexture = nullptr; // all tiles come from one tileset 
+    mutable size_t chunksDrawn {}; 
+
+    std::unique_ptr<TileChunkStreamer> streamer; 
+    size_t streamingBudget {}; 
+    std::list<size_t> residentChunks; // chunk indices, most recently used first 
+    std::vector<TileChunkStreamer::LoadedChunk> loadedChunks; // reused between updates
+
+    std::uint16_t streamedTileType(unsigned int x, unsigned int y) const; 
+    size_t chunkBytes(const TileChunk& chunk) const; 
+    void evictChunk(size_t chunkIndex); 
+
+    void loadText(const std::filesystem::path& filePath); 
+    void loadBinary(const std::filesystem::path& filePath); 
+    void setupChunks(); 
+    void rebuildChunk(size_t chunkX, size_t chunkY) const; 
+
     // Override the draw function of sf::Drawable to draw all tiles
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 };
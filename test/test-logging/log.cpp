@@ -1,80 +1,247 @@
 #include "log.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <fmt/args.h>
+
 #if ENABLE_LOGGING
 
-struct LogEntry {
-    std::string message;
-    spdlog::level::level_enum level;
+// fixed-size slot in the log ring. messages that fit are copied into the slot; longer ones (rare, e.g. bitmask dumps) are moved 
+// to the heap so they still arrive whole
+struct alignas(64) LogRecord {
+    static constexpr size_t TEXT_BYTES = log_detail::DEFERRED_PAYLOAD_BYTES; 
+
+    std::atomic<size_t> sequence{0}; // ring position this slot is ready for; see LogRing
+    spdlog::level::level_enum level = spdlog::level::info;
+    std::uint16_t length = 0; 
+    std::string* heapText = nullptr; 
+    const char* format = nullptr; // set for deferred messages; text then holds their encoded arguments
+    char text[TEXT_BYTES]; 
 };
+static_assert(sizeof(LogRecord) <= 256, "log records should stay 4 cache lines");
 
-class LogQueue {
+/* LogRing is a bounded multi-producer single-consumer queue of preallocated records (Vyukov's bounded queue). producers claim a 
+slot with one CAS on the write position and publish it by storing its sequence; the logging thread reads slots in order and hands 
+them back by moving their sequence a lap ahead. nothing is allocated after construction */
+class LogRing {
 public:
-    void push(LogEntry entry) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(std::move(entry));
-        condition_.notify_one();
+    explicit LogRing(size_t capacity) : records(new LogRecord[capacity]), mask(capacity - 1) {
+        for (size_t i = 0; i < capacity; ++i) records[i].sequence.store(i, std::memory_order_relaxed);
     }
 
-    bool pop(LogEntry& entry) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        condition_.wait(lock, [this] { return !queue_.empty() || stop_; });
-        if (stop_ && queue_.empty())
-            return false;
-        entry = std::move(queue_.front());
-        queue_.pop();
-        return true;
+    // a free slot and its position, or nullptr if the ring is full
+    LogRecord* claim(size_t& position) {
+        position = writePosition.load(std::memory_order_relaxed);
+        while (true) {
+            LogRecord& record = records[position & mask];
+            size_t sequence = record.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (lag == 0) {
+                if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) return &record;
+            }
+            else if (lag < 0) {
+                return nullptr; // the slot still holds a record from the last lap
+            }
+            else {
+                position = writePosition.load(std::memory_order_relaxed);
+            }
+        }
     }
 
-    void stop() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        stop_ = true;
-        condition_.notify_all();
+    void publish(LogRecord& record, size_t position) { record.sequence.store(position + 1, std::memory_order_release); }
+
+    // consumer side; the next record in order, or nullptr if it isn't published yet
+    LogRecord* peek() {
+        LogRecord& record = records[readPosition & mask];
+        return record.sequence.load(std::memory_order_acquire) == readPosition + 1 ? &record : nullptr;
+    }
+
+    void pop() {
+        records[readPosition & mask].sequence.store(readPosition + mask + 1, std::memory_order_release);
+        ++readPosition;
     }
 
+    size_t capacity() const { return mask + 1; }
+
 private:
-    std::queue<LogEntry> queue_;
-    std::mutex mutex_;
-    std::condition_variable condition_;
-    bool stop_ = false;
+    std::unique_ptr<LogRecord[]> records; 
+    size_t mask; 
+    alignas(64) std::atomic<size_t> writePosition{0}; 
+    alignas(64) size_t readPosition = 0; // only touched by the logging thread
 };
 
+/* AsyncLogger copies messages into the ring and returns; its thread writes them to spdlog in batches. the thread isn't woken per 
+message: it sleeps up to FLUSH_INTERVAL when the ring is empty and is only notified for warnings and errors, every half ring of 
+messages, and while a Block producer waits for room. files are flushed every FLUSH_INTERVAL, and right away for warnings and errors (flush_on in init_logging) */
 class AsyncLogger {
 public:
-    AsyncLogger() : logging_thread_(&AsyncLogger::processLogQueue, this), stop_thread_(false) {}
+    static constexpr size_t RING_CAPACITY = 4096; // records, a power of two 
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{200}; 
+
+    AsyncLogger() : ring(RING_CAPACITY) {
+        logging_thread_ = std::thread(&AsyncLogger::processLogQueue, this); // started last, once every member exists
+    }
 
     ~AsyncLogger() {
-        stop_thread_ = true;
-        log_queue_.stop();
+        stop_thread_.store(true, std::memory_order_release);
+        wake_.notify_one();
         if (logging_thread_.joinable()) {
             logging_thread_.join();
         }
     }
 
     void log(const std::string& message, spdlog::level::level_enum level) {
-        log_queue_.push({message, level});
+        size_t position = 0;
+        LogRecord* record = claim(level, position);
+        if (!record) return;
+
+        record->format = nullptr;
+        if (message.size() <= LogRecord::TEXT_BYTES) {
+            std::memcpy(record->text, message.data(), message.size());
+            record->length = static_cast<std::uint16_t>(message.size());
+            record->heapText = nullptr;
+        } else {
+            record->length = 0;
+            record->heapText = new std::string(message);
+        }
+        publish(*record, position);
+    }
+
+    // a record for the caller to fill and publish, or nullptr if the message is dropped under the overflow policy
+    LogRecord* claim(spdlog::level::level_enum level, size_t& position) {
+        LogRecord* record = ring.claim(position);
+        while (!record) {
+            LogOverflowPolicy policy = overflow_policy_.load(std::memory_order_relaxed);
+            if (policy != LogOverflowPolicy::Block && level < spdlog::level::warn) { // warnings and errors always wait for room
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            wake_.notify_one();
+            std::this_thread::yield();
+            record = ring.claim(position);
+        }
+        record->level = level;
+        return record;
+    }
+
+    void publish(LogRecord& record, size_t position) {
+        spdlog::level::level_enum level = record.level; // the record may be consumed as soon as it's published
+        ring.publish(record, position);
+        if (level >= spdlog::level::warn || (position & (RING_CAPACITY / 2 - 1)) == 0) wake_.notify_one();
+    }
+
+    void setOverflowPolicy(LogOverflowPolicy policy) { overflow_policy_.store(policy, std::memory_order_relaxed); }
+
+    // called by init_logging. the thread keeps its own references, so records still pending at exit are written after spdlog::shutdown
+    void setLoggers(std::shared_ptr<spdlog::logger> infoLogger, std::shared_ptr<spdlog::logger> errorLogger) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            info_logger_ = std::move(infoLogger);
+            error_logger_ = std::move(errorLogger);
+        }
+        wake_.notify_one();
     }
 
 private:
     void processLogQueue() {
-        LogEntry entry;
-        while (!stop_thread_ && log_queue_.pop(entry)) {
-            auto logger = spdlog::get(entry.level == spdlog::level::err ? "error_logger" : "info_logger");
-            if (logger) {
-                if (entry.level == spdlog::level::info) {
-                    logger->info(entry.message);
-                } else if (entry.level == spdlog::level::warn) {
-                    logger->warn(entry.message);
-                } else if (entry.level == spdlog::level::err) {
-                    logger->error(entry.message);
-                }
-                logger->flush();
+        std::shared_ptr<spdlog::logger> infoLogger, errorLogger;
+        auto lastFlush = std::chrono::steady_clock::now();
+
+        while (true) {
+            bool stopping = stop_thread_.load(std::memory_order_acquire);
+            if (!infoLogger || !errorLogger) {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                infoLogger = info_logger_;
+                errorLogger = error_logger_;
+            }
+            if ((!infoLogger || !errorLogger) && !stopping) { // init_logging hasn't run yet, keep the records until it has
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            size_t drained = 0;
+            while (LogRecord* record = ring.peek()) {
+                writeRecord(*record, record->level == spdlog::level::err ? errorLogger : infoLogger);
+                ring.pop();
+                ++drained;
+            }
+
+            size_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+            if (dropped && infoLogger && overflow_policy_.load(std::memory_order_relaxed) == LogOverflowPolicy::Count) {
+                infoLogger->warn("{} log messages dropped, the log ring was full", dropped);
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastFlush >= FLUSH_INTERVAL) {
+                if (infoLogger) infoLogger->flush();
+                if (errorLogger) errorLogger->flush();
+                lastFlush = now;
+            }
+
+            if (stopping && drained == 0) break; // everything logged before the stop is written
+            if (drained == 0) {
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_.wait_for(lock, FLUSH_INTERVAL);
+            }
+        }
+
+        if (infoLogger) infoLogger->flush();
+        if (errorLogger) errorLogger->flush();
+    }
+
+    static void writeRecord(LogRecord& record, const std::shared_ptr<spdlog::logger>& logger) {
+        if (record.format) {
+            if (logger) logger->log(record.level, formatDeferred(record));
+            return;
+        }
+        std::string_view message = record.heapText ? std::string_view(*record.heapText) : std::string_view(record.text, record.length);
+        if (logger) logger->log(record.level, message);
+        delete record.heapText;
+        record.heapText = nullptr;
+    }
+
+    // decodes the arguments log_detail::encodeLogArg wrote and formats them with the record's format string
+    static std::string formatDeferred(const LogRecord& record) {
+        using log_detail::LogArgType;
+        fmt::dynamic_format_arg_store<fmt::format_context> arguments;
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(record.text);
+        const unsigned char* end = in + record.length;
+
+        while (in < end) {
+            LogArgType type = static_cast<LogArgType>(*in++);
+            if (type == LogArgType::Signed) { std::int64_t value; std::memcpy(&value, in, sizeof(value)); in += sizeof(value); arguments.push_back(value); }
+            else if (type == LogArgType::Unsigned) { std::uint64_t value; std::memcpy(&value, in, sizeof(value)); in += sizeof(value); arguments.push_back(value); }
+            else if (type == LogArgType::Float) { double value; std::memcpy(&value, in, sizeof(value)); in += sizeof(value); arguments.push_back(value); }
+            else if (type == LogArgType::Bool) { arguments.push_back(*in++ != 0); }
+            else {
+                std::uint32_t length; 
+                std::memcpy(&length, in, sizeof(length)); 
+                in += sizeof(length);
+                arguments.push_back(fmt::string_view(reinterpret_cast<const char*>(in), length)); // formatted before the record is reused
+                in += length;
             }
         }
+
+        try {
+            return fmt::vformat(record.format, arguments);
+        }
+        catch (const fmt::format_error& e) {
+            return std::string(record.format) + " [bad log format: " + e.what() + "]";
+        }
     }
 
-    LogQueue log_queue_;
+    LogRing ring;
+    std::atomic<bool> stop_thread_{false};
+    std::atomic<LogOverflowPolicy> overflow_policy_{LogOverflowPolicy::Count};
+    std::atomic<size_t> dropped_{0};
+    std::mutex wake_mutex_; // also guards the loggers below
+    std::condition_variable wake_;
+    std::shared_ptr<spdlog::logger> info_logger_, error_logger_; 
     std::thread logging_thread_;
-    std::atomic<bool> stop_thread_;
 };
 
 // Singleton instance for AsyncLogger
@@ -93,6 +260,29 @@ void log_error(const std::string& message) {
     asyncLogger.log(message, spdlog::level::err);
 }
 
+void set_log_overflow_policy(LogOverflowPolicy policy) {
+    asyncLogger.setOverflowPolicy(policy);
+}
+
+namespace log_detail {
+    DeferredSlot claimDeferred(spdlog::level::level_enum level, const char* format) {
+        DeferredSlot slot;
+        LogRecord* record = asyncLogger.claim(level, slot.position);
+        if (!record) return slot;
+        record->format = format;
+        record->heapText = nullptr;
+        slot.record = record;
+        slot.data = reinterpret_cast<unsigned char*>(record->text);
+        return slot;
+    }
+
+    void publishDeferred(const DeferredSlot& slot, size_t bytes) {
+        LogRecord* record = static_cast<LogRecord*>(slot.record);
+        record->length = static_cast<std::uint16_t>(bytes);
+        asyncLogger.publish(*record, slot.position);
+    }
+}
+
 // Logging initialization and cleanup
 void init_logging() {
     std::string info_log_file = "test/test-logging/loggingFiles/info.txt";
@@ -118,10 +308,13 @@ void init_logging() {
 
     info_logger->set_level(spdlog::level::info);
     error_logger->set_level(spdlog::level::err);
+    info_logger->flush_on(spdlog::level::warn); // the logging thread flushes everything else every FLUSH_INTERVAL
+    error_logger->flush_on(spdlog::level::err);
 
     spdlog::register_logger(info_logger);
     spdlog::register_logger(error_logger);
     spdlog::set_default_logger(info_logger);
+    asyncLogger.setLoggers(info_logger, error_logger);
 }
 
 void cleanup_logging() {
@@ -139,3 +332,124 @@ public:
 inline LoggerManager loggerManager;
 
 #endif // ENABLE_LOGGING
+
+#if ENABLE_PROFILING
+
+FrameProfiler::FrameProfiler() 
+    : epoch(std::chrono::steady_clock::now()), zones(FRAME_CAPACITY * ZONES_PER_FRAME), frames(FRAME_CAPACITY) {}
+
+void FrameProfiler::beginFrame() {
+    currentFrame = &frames[framesBegun % FRAME_CAPACITY];
+    currentFrame->start = now();
+    currentFrame->number = framesBegun++;
+    currentFrame->zoneCount = 0;
+    depth = 0;
+}
+
+FrameProfiler::Zone* FrameProfiler::beginZone(const char* name) {
+    if (!currentFrame) return nullptr;
+    if (currentFrame->zoneCount == ZONES_PER_FRAME) {
+        ++droppedZones;
+        return nullptr;
+    }
+
+    Zone* zone = &zones[(currentFrame - frames.data()) * ZONES_PER_FRAME + currentFrame->zoneCount++];
+    zone->name = name;
+    zone->depth = depth++;
+    zone->end = -1; // still open
+    zone->start = now(); // last, so the bookkeeping above isn't timed
+    return zone;
+}
+
+void FrameProfiler::endZone(Zone* zone) {
+    if (!zone) return;
+    zone->end = now();
+    if (depth) --depth;
+}
+
+template<typename Visit>
+void FrameProfiler::forEachFrame(Visit&& visit) const {
+    std::uint64_t kept = std::min<std::uint64_t>(framesBegun, FRAME_CAPACITY);
+    for (std::uint64_t number = framesBegun - kept; number < framesBegun; ++number) {
+        const Frame& frame = frames[number % FRAME_CAPACITY];
+        std::int64_t end = number + 1 < framesBegun ? frames[(number + 1) % FRAME_CAPACITY].start : now();
+        visit(frame, &zones[(number % FRAME_CAPACITY) * ZONES_PER_FRAME], end);
+    }
+}
+
+void FrameProfiler::logSummary() const {
+    // per zone name, its total time in every frame it ran in; "frame" is the whole frame
+    std::vector<std::pair<std::string_view, std::vector<std::int64_t>>> totals { { "frame", {} } };
+    std::unordered_map<std::string_view, size_t> totalIndex { { "frame", 0 } };
+    std::vector<std::int64_t> frameTotals;
+
+    forEachFrame([&](const Frame& frame, const Zone* frameZones, std::int64_t frameEnd) {
+        totals[0].second.push_back(frameEnd - frame.start);
+        frameTotals.assign(totals.size(), -1);
+        for (size_t i = 0; i < frame.zoneCount; ++i) {
+            const Zone& zone = frameZones[i];
+            if (zone.end < 0) continue;
+            auto [it, added] = totalIndex.try_emplace(zone.name, totals.size());
+            if (added) {
+                totals.emplace_back(zone.name, std::vector<std::int64_t>{});
+                frameTotals.push_back(-1);
+            }
+            std::int64_t& total = frameTotals[it->second];
+            total = std::max<std::int64_t>(total, 0) + (zone.end - zone.start);
+        }
+        for (size_t i = 1; i < totals.size(); ++i) {
+            if (frameTotals[i] >= 0) totals[i].second.push_back(frameTotals[i]);
+        }
+    });
+
+    for (auto& [name, durations] : totals) {
+        if (durations.empty()) continue;
+        std::sort(durations.begin(), durations.end());
+        double sum = 0.0;
+        for (std::int64_t duration : durations) sum += duration;
+        size_t p99 = (durations.size() * 99 + 99) / 100 - 1; // nearest rank
+        log_infof("\tProfile {}: {} frames, min {:.3f}ms avg {:.3f}ms p99 {:.3f}ms", std::string(name), durations.size(), 
+                  durations.front() * 1e-6, sum / durations.size() * 1e-6, durations[p99] * 1e-6);
+    }
+    if (droppedZones) log_warningf("\tProfile dropped {} zones, more than {} in a frame", droppedZones, ZONES_PER_FRAME);
+}
+
+bool FrameProfiler::writeChromeTrace(const std::filesystem::path& filePath) const {
+    std::ofstream out(filePath, std::ios::trunc);
+    if (!out) {
+        log_warning("Failed to write profiler trace " + filePath.string());
+        return false;
+    }
+
+    // complete ("X") events with microsecond timestamps; zones nest inside their frame by time
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    bool first = true;
+    auto writeEvent = [&](std::string_view name, std::int64_t start, std::int64_t end) {
+        out << (first ? "" : ",\n") << "{\"name\":\"";
+        for (char c : name) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << start * 1e-3 << ",\"dur\":" << (end - start) * 1e-3 << "}";
+        first = false;
+    };
+
+    forEachFrame([&](const Frame& frame, const Zone* frameZones, std::int64_t frameEnd) {
+        writeEvent("frame " + std::to_string(frame.number), frame.start, frameEnd);
+        for (size_t i = 0; i < frame.zoneCount; ++i) {
+            if (frameZones[i].end >= 0) writeEvent(frameZones[i].name, frameZones[i].start, frameZones[i].end);
+        }
+    });
+    out << "\n]}\n";
+
+    if (!out) {
+        log_warning("Failed to write profiler trace " + filePath.string());
+        return false;
+    }
+    log_info("\tProfiler trace written to " + filePath.string());
+    return true;
+}
+
+#endif // ENABLE_PROFILING
@@ -1,10 +1,79 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <atomic>
+#include <iterator>
 
 // Define a macro to enable or disable logging
 #define ENABLE_LOGGING 1  // Set to 1 to enable logging, 0 to disable logging
 
+/* lowest log level compiled in (0 info, 1 warning, 2 error, 3 off), for all subsystems or one of them, e.g. -DLOG_LEVEL_PHYSICS=1.
+LOG_INFO/LOG_WARNING/LOG_ERROR calls below it compile to nothing, their arguments included */
+#ifndef LOG_MIN_LEVEL
+#if ENABLE_LOGGING
+#define LOG_MIN_LEVEL 0
+#else
+#define LOG_MIN_LEVEL 3
+#endif
+#endif
+#ifndef LOG_LEVEL_PHYSICS
+#define LOG_LEVEL_PHYSICS LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_SPRITES
+#define LOG_LEVEL_SPRITES LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_TILES
+#define LOG_LEVEL_TILES LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_SCENES
+#define LOG_LEVEL_SCENES LOG_MIN_LEVEL
+#endif
+#ifndef LOG_LEVEL_ASSETS
+#define LOG_LEVEL_ASSETS LOG_MIN_LEVEL
+#endif
+
+enum class LogLevel { Info, Warning, Error, Off };
+enum class LogSubsystem { Physics, Sprites, Tiles, Scenes, Assets, Count };
+
+namespace log_detail {
+    inline constexpr int compiledLogLevels[] = { LOG_LEVEL_PHYSICS, LOG_LEVEL_SPRITES, LOG_LEVEL_TILES, LOG_LEVEL_SCENES, LOG_LEVEL_ASSETS };
+    static_assert(std::size(compiledLogLevels) == static_cast<size_t>(LogSubsystem::Count), "one compile time level per subsystem");
+
+    constexpr bool compiledIn(LogSubsystem subsystem, LogLevel level) {
+        return static_cast<int>(level) >= compiledLogLevels[static_cast<size_t>(subsystem)];
+    }
+
+    inline std::atomic<LogLevel> runtimeLogLevels[static_cast<size_t>(LogSubsystem::Count)] {}; // all Info until set_log_level
+
+    inline bool enabledAtRuntime(LogSubsystem subsystem, LogLevel level) {
+        return level >= runtimeLogLevels[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+    }
+}
+
+// lowest level a subsystem logs at while running; it can't bring back calls the compile time level removed
+inline void set_log_level(LogSubsystem subsystem, LogLevel level) {
+    log_detail::runtimeLogLevels[static_cast<size_t>(subsystem)].store(level, std::memory_order_relaxed);
+}
+inline LogLevel get_log_level(LogSubsystem subsystem) {
+    return log_detail::runtimeLogLevels[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+}
+
+/* subsystem logging, e.g. LOG_INFO(Physics, "Quadtree merged at level {}", level). the arguments are the same as log_infof's, 
+and they are only evaluated when the call is compiled in and the subsystem's runtime level lets it through */
+#define LOG_AT(subsystem, level, logCall, ...) \
+    do { \
+        if constexpr (log_detail::compiledIn(LogSubsystem::subsystem, LogLevel::level)) { \
+            if (log_detail::enabledAtRuntime(LogSubsystem::subsystem, LogLevel::level)) logCall(__VA_ARGS__); \
+        } \
+    } while (0)
+#define LOG_INFO(subsystem, ...) LOG_AT(subsystem, Info, log_infof, __VA_ARGS__)
+#define LOG_WARNING(subsystem, ...) LOG_AT(subsystem, Warning, log_warningf, __VA_ARGS__)
+#define LOG_ERROR(subsystem, ...) LOG_AT(subsystem, Error, log_errorf, __VA_ARGS__)
+
 #if ENABLE_LOGGING
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
@@ -19,12 +88,121 @@
 #include <csignal>
 
 
+// what log calls do when the log ring is full: Drop the message, Block until there is room, or Count (drop, and have the 
+// logging thread report how many were dropped). the default is Count. warnings and errors are never dropped
+enum class LogOverflowPolicy { Drop, Block, Count };
+
 void init_logging();
+void set_log_overflow_policy(LogOverflowPolicy policy);
 void log_info(const std::string& message);
 void log_warning(const std::string& message);
 void log_error(const std::string& message);
 void cleanup_logging();
 
+// format string of a deferred log call; only string literals convert to it, since it's read later on the logging thread
+struct LogFormat {
+    template<size_t N>
+    constexpr LogFormat(const char (&literal)[N]) : text(literal) {}
+    const char* text; 
+};
+
+namespace log_detail {
+    inline constexpr size_t DEFERRED_PAYLOAD_BYTES = 224; // argument bytes that fit in one log record
+
+    enum class LogArgType : std::uint8_t { Signed, Unsigned, Float, Bool, Text };
+
+    // a claimed log record; data is nullptr if the message was dropped (see LogOverflowPolicy)
+    struct DeferredSlot {
+        unsigned char* data = nullptr; 
+        void* record = nullptr; 
+        size_t position = 0; 
+    };
+    DeferredSlot claimDeferred(spdlog::level::level_enum level, const char* format);
+    void publishDeferred(const DeferredSlot& slot, size_t bytes);
+
+    template<typename> inline constexpr bool unsupportedLogArg = false;
+
+    template<typename T>
+    constexpr size_t encodedLogArgSize(const T& value) {
+        if constexpr (std::is_same_v<T, bool>) return 2;
+        else if constexpr (std::is_arithmetic_v<T>) return 1 + 8;
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) return 1 + 4 + std::string_view(value).size();
+        else static_assert(unsupportedLogArg<T>, "deferred log arguments can be numbers, bools and strings");
+    }
+
+    // a type tag, then the value as 8 raw bytes (strings: 4 byte length and the characters)
+    template<typename T>
+    unsigned char* encodeLogArg(unsigned char* out, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            *out++ = static_cast<unsigned char>(LogArgType::Bool);
+            *out++ = value ? 1 : 0;
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            double widened = value;
+            *out++ = static_cast<unsigned char>(LogArgType::Float);
+            std::memcpy(out, &widened, 8);
+            out += 8;
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            std::int64_t widened = value;
+            *out++ = static_cast<unsigned char>(LogArgType::Signed);
+            std::memcpy(out, &widened, 8);
+            out += 8;
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            std::uint64_t widened = value;
+            *out++ = static_cast<unsigned char>(LogArgType::Unsigned);
+            std::memcpy(out, &widened, 8);
+            out += 8;
+        }
+        else {
+            std::string_view text(value);
+            std::uint32_t length = static_cast<std::uint32_t>(text.size());
+            *out++ = static_cast<unsigned char>(LogArgType::Text);
+            std::memcpy(out, &length, 4);
+            std::memcpy(out + 4, text.data(), length);
+            out += 4 + length;
+        }
+        return out;
+    }
+
+    template<typename... Args>
+    void logDeferred(spdlog::level::level_enum level, const char* format, const Args&... args) {
+        size_t bytes = (size_t{0} + ... + encodedLogArgSize(args));
+        if (bytes > DEFERRED_PAYLOAD_BYTES) { // too big for a record (long strings): format here instead
+            std::string message;
+            try {
+                message = fmt::format(fmt::runtime(format), args...);
+            }
+            catch (const fmt::format_error& e) {
+                message = std::string(format) + " [bad log format: " + e.what() + "]";
+            }
+            if (level >= spdlog::level::err) log_error(message);
+            else if (level == spdlog::level::warn) log_warning(message);
+            else log_info(message);
+            return;
+        }
+
+        DeferredSlot slot = claimDeferred(level, format);
+        if (!slot.data) return;
+        [[maybe_unused]] unsigned char* out = slot.data; // unused when there are no arguments
+        ((out = encodeLogArg(out, args)), ...);
+        publishDeferred(slot, bytes);
+    }
+}
+
+/* deferred logging, e.g. log_infof("Sprite inserted at level {}", level): the game thread only copies the format pointer and the 
+raw arguments into the log ring, the logging thread formats them ({fmt} syntax). for hot paths where building the string with 
+std::to_string and + would cost more than the message is worth */
+template<typename... Args>
+void log_infof(LogFormat format, const Args&... args) { log_detail::logDeferred(spdlog::level::info, format.text, args...); }
+
+template<typename... Args>
+void log_warningf(LogFormat format, const Args&... args) { log_detail::logDeferred(spdlog::level::warn, format.text, args...); }
+
+template<typename... Args>
+void log_errorf(LogFormat format, const Args&... args) { log_detail::logDeferred(spdlog::level::err, format.text, args...); }
+
 class Timer { // code by cherno, from: https://gist.github.com/TheCherno/b2c71c9291a4a1a29c889e76173c8d14 
 public:
     Timer() { Reset(); }
@@ -56,12 +234,23 @@ private:
 
 #else
 
+enum class LogOverflowPolicy { Drop, Block, Count };
+
 inline void init_logging() {}
+inline void set_log_overflow_policy(LogOverflowPolicy policy) {}
 inline void log_info(const std::string& message) {}
 inline void log_warning(const std::string& message) {}
 inline void log_error(const std::string& message) {}
 inline void cleanup_logging() {}
 
+struct LogFormat {
+    template<size_t N>
+    constexpr LogFormat(const char (&literal)[N]) {}
+};
+template<typename... Args> inline void log_infof(LogFormat format, const Args&... args) {}
+template<typename... Args> inline void log_warningf(LogFormat format, const Args&... args) {}
+template<typename... Args> inline void log_errorf(LogFormat format, const Args&... args) {}
+
 class Timer {
 public:
     Timer() {}
@@ -78,3 +267,83 @@ public:
 };
 
 #endif // ENABLE_LOGGING
+
+// Define a macro to enable or disable the frame profiler, also from the build, e.g. -DENABLE_PROFILING=1
+#ifndef ENABLE_PROFILING
+#define ENABLE_PROFILING 0  // Set to 1 to record PROFILE_ZONE timings, 0 to compile them out
+#endif
+
+#if ENABLE_PROFILING
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+/* hierarchical frame profiler for the game loop thread. PROFILE_FRAME() starts a frame and PROFILE_ZONE("name") times the rest of 
+its scope, like ScopedTimer, but into a preallocated ring of the last FRAME_CAPACITY frames instead of the log. PROFILE_REPORT() 
+logs min/avg/p99 per zone and writes the ring as a Chrome trace (chrome://tracing, ui.perfetto.dev) */
+class FrameProfiler {
+public:
+    static constexpr size_t FRAME_CAPACITY = 600; // frames kept, 10 seconds at 60 fps
+    static constexpr size_t ZONES_PER_FRAME = 128; // zones past this in one frame are counted and dropped
+    static constexpr const char* TRACE_PATH = "test/test-logging/loggingFiles/trace.json"; 
+
+    struct Zone {
+        const char* name; // a string literal, zones are grouped by its text
+        std::int64_t start; // nanoseconds since the profiler was made
+        std::int64_t end; 
+        std::uint16_t depth; // zones open around this one
+    };
+
+    FrameProfiler();
+    void beginFrame(); 
+    Zone* beginZone(const char* name); // nullptr before the first frame or when the frame is full
+    void endZone(Zone* zone); 
+    void logSummary() const; 
+    bool writeChromeTrace(const std::filesystem::path& filePath) const; 
+
+    std::int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count(); }
+
+private:
+    struct Frame {
+        std::int64_t start = 0; 
+        std::uint64_t number = 0; 
+        size_t zoneCount = 0; 
+    };
+
+    template<typename Visit> void forEachFrame(Visit&& visit) const; // oldest first, with the next frame's start (or now) as its end
+
+    std::chrono::steady_clock::time_point epoch; 
+    std::vector<Zone> zones; // FRAME_CAPACITY * ZONES_PER_FRAME, the zones of frame i start at i * ZONES_PER_FRAME
+    std::vector<Frame> frames; 
+    std::uint64_t framesBegun = 0; 
+    Frame* currentFrame = nullptr; 
+    std::uint16_t depth = 0; 
+    size_t droppedZones = 0; 
+};
+inline FrameProfiler frameProfiler;
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : zone(frameProfiler.beginZone(name)) {}
+    ~ProfileZone() { frameProfiler.endZone(zone); }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    FrameProfiler::Zone* zone; 
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_FRAME() frameProfiler.beginFrame()
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_REPORT() (frameProfiler.logSummary(), frameProfiler.writeChromeTrace(FrameProfiler::TRACE_PATH))
+
+#else
+
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_REPORT() ((void)0)
+
+#endif // ENABLE_PROFILING
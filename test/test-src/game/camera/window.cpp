@@ -1,8 +1,107 @@
 #include "window.hpp"
 
-GameWindow::GameWindow(unsigned int screenWidth, unsigned int screenHeight, std::string gameTitle, unsigned int frameRate ) : window(sf::VideoMode(screenWidth, screenHeight), gameTitle) {
+#include <algorithm>
+#include <cstring>
+
+// a headless GameWindow keeps its RenderWindow unopened, so nothing is drawn (CI, benchmarks). pair it with 
+// Constants::initialize(true), which skips the texture uploads, and no GL context is needed 
+GameWindow::GameWindow(unsigned int screenWidth, unsigned int screenHeight, std::string gameTitle, unsigned int frameRate, bool headless ) : headless(headless) {
+    if (headless) {
+        log_info("\tRunning headless, no window created");
+        return; 
+    }
+    window.create(sf::VideoMode(screenWidth, screenHeight), gameTitle);
     window.setFramerateLimit(frameRate); 
 }
 
 GameView::GameView(sf::FloatRect viewRect) : view(sf::View(viewRect)){}
 
+
+// flipped (negative) texture rects still map the right way round 
+void writeSpriteQuad(sf::Vertex* quad, const sf::Sprite& sprite) {
+    const sf::Transform& transform = sprite.getTransform(); 
+    const sf::IntRect& textureRect = sprite.getTextureRect(); 
+    sf::FloatRect bounds = sprite.getLocalBounds(); 
+    sf::Color color = sprite.getColor(); 
+
+    float left = static_cast<float>(textureRect.left); 
+    float right = left + textureRect.width; 
+    float top = static_cast<float>(textureRect.top); 
+    float bottom = top + textureRect.height; 
+
+    quad[0] = sf::Vertex(transform.transformPoint(0.0f, 0.0f), color, sf::Vector2f(left, top)); 
+    quad[1] = sf::Vertex(transform.transformPoint(bounds.width, 0.0f), color, sf::Vector2f(right, top)); 
+    quad[2] = sf::Vertex(transform.transformPoint(bounds.width, bounds.height), color, sf::Vector2f(right, bottom)); 
+    quad[3] = sf::Vertex(transform.transformPoint(0.0f, bounds.height), color, sf::Vector2f(left, bottom)); 
+}
+
+void SpriteBatch::begin() {
+    for (auto& batch : batches) batch.used = 0; 
+}
+
+void SpriteBatch::add(const sf::Sprite& sprite, bool visible) {
+    const sf::Texture* texture = sprite.getTexture(); 
+    if (!texture) return; 
+
+    Batch& batch = batchFor(texture); 
+    size_t slotIndex = batch.used++; 
+    if (slotIndex == batch.slots.size()) {
+        batch.slots.emplace_back(); 
+        batch.vertices.resize(batch.slots.size() * 4); 
+    }
+
+    SlotState& slot = batch.slots[slotIndex]; 
+    if (!slotChanged(slot, sprite, visible)) return; 
+
+    slot.sprite = &sprite; 
+    slot.transform = sprite.getTransform(); 
+    slot.textureRect = sprite.getTextureRect(); 
+    slot.color = sprite.getColor(); 
+    slot.visible = visible; 
+
+    sf::Vertex* quad = &batch.vertices[slotIndex * 4]; 
+    if (!visible) {
+        for (int i = 0; i < 4; ++i) quad[i] = sf::Vertex(); // zero area, nothing gets rasterized
+        return; 
+    }
+
+    writeSpriteQuad(quad, sprite); 
+}
+
+void SpriteBatch::end() {
+    for (auto& batch : batches) {
+        if (batch.used == batch.slots.size()) continue; 
+        batch.slots.resize(batch.used); 
+        batch.vertices.resize(batch.used * 4); 
+    }
+}
+
+size_t SpriteBatch::getBatchCount() const {
+    return static_cast<size_t>(std::count_if(batches.begin(), batches.end(), [](const Batch& batch) {
+        return batch.vertices.getVertexCount() != 0; 
+    })); 
+}
+
+SpriteBatch::Batch& SpriteBatch::batchFor(const sf::Texture* texture) {
+    for (auto& batch : batches) {
+        if (batch.texture == texture) return batch; 
+    }
+    batches.emplace_back(); 
+    batches.back().texture = texture; 
+    return batches.back(); 
+}
+
+bool SpriteBatch::slotChanged(const SlotState& slot, const sf::Sprite& sprite, bool visible) const {
+    if (slot.sprite != &sprite || slot.visible != visible) return true; 
+    if (!visible) return false; // still hidden, the quad is already empty
+    return std::memcmp(slot.transform.getMatrix(), sprite.getTransform().getMatrix(), 16 * sizeof(float)) != 0 ||
+           slot.textureRect != sprite.getTextureRect() || slot.color != sprite.getColor(); 
+}
+
+void SpriteBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    for (const auto& batch : batches) {
+        if (batch.vertices.getVertexCount() == 0) continue; 
+        states.texture = batch.texture; 
+        target.draw(batch.vertices, states); 
+    }
+}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <vector>
+#include <memory>
 #include "../test-logging/log.hpp" 
 
 
 class GameWindow{
 public: 
-    GameWindow( unsigned int screenWidth, unsigned int screenHeight, std::string gameTitle, unsigned int frameRate );
+    GameWindow( unsigned int screenWidth, unsigned int screenHeight, std::string gameTitle, unsigned int frameRate, bool headless = false );
     sf::RenderWindow& getWindow() { return window; } 
+    bool isHeadless() const { return headless; } // headless windows are never opened, so nothing is drawn 
     ~GameWindow() = default;
 
     explicit operator bool() const {
@@ -16,6 +19,7 @@ public:
 
 private:
     sf::RenderWindow window;
+    bool headless; 
 };
 
 class GameView{
@@ -34,3 +38,47 @@ private:
 
 };
 
+
+// writes the 4 corners of a sprite as a quad, with the same positions and texture coordinates sf::Sprite draws with 
+void writeSpriteQuad(sf::Vertex* quad, const sf::Sprite& sprite); 
+
+/* SpriteBatch collects sprites into one quad vertex array per texture, so drawing costs one draw call per texture instead of one 
+per sprite. Sprites should be added in the same order every frame; a quad is only rewritten when the sprite in its slot moved, 
+changed its texture rect or color, or was hidden/shown */
+class SpriteBatch : public sf::Drawable {
+public:
+    void begin(); // call before adding this frame's sprites
+    void add(const sf::Sprite& sprite, bool visible = true); 
+    void end(); // drops slots left over from a bigger previous frame
+
+    template<typename SpriteType>
+    void addAll(const std::vector<std::unique_ptr<SpriteType>>& sprites) {
+        for (const auto& sprite : sprites) {
+            if (sprite) add(sprite->returnSpritesShape(), sprite->getVisibleState()); 
+        }
+    }
+
+    size_t getBatchCount() const; // draw calls per frame, empty batches are skipped by draw
+
+private:
+    struct SlotState {
+        const sf::Sprite* sprite = nullptr; 
+        sf::Transform transform; 
+        sf::IntRect textureRect; 
+        sf::Color color; 
+        bool visible = false; 
+    };
+
+    struct Batch {
+        const sf::Texture* texture = nullptr; 
+        sf::VertexArray vertices { sf::Quads }; 
+        std::vector<SlotState> slots; 
+        size_t used = 0; 
+    };
+
+    Batch& batchFor(const sf::Texture* texture); 
+    bool slotChanged(const SlotState& slot, const sf::Sprite& sprite, bool visible) const; 
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    std::vector<Batch> batches; // in the order their textures were first added, which is also the draw order
+};
@@ -11,17 +11,30 @@ GameManager::GameManager()
     log_info("\tGame initialized");
 }
 
+// headless GameManager never opens a window, scenes still get the (closed) window so their code paths stay the same 
+GameManager::GameManager(std::vector<ScriptedEvent> inputScript)
+    : mainWindow(Constants::VIEW_SIZE_X, Constants::VIEW_SIZE_Y, Constants::GAME_TITLE, Constants::FRAME_LIMIT, true), script(std::move(inputScript)) {
+    std::stable_sort(script.begin(), script.end(), [](const ScriptedEvent& a, const ScriptedEvent& b) { return a.step < b.step; });
+
+    introScreenScene = std::make_unique<introScene>(mainWindow.getWindow());
+    gameScene = std::make_unique<gamePlayScene>(mainWindow.getWindow());
+    gameSceneNext = std::make_unique<gamePlayScene2>(mainWindow.getWindow()); 
+
+    log_info("\tHeadless game initialized");
+}
+
 // runGame calls to createAssets from scenes and loops until window is closed to run scene events 
 void GameManager::runGame() {
     try {     
         loadScenes(); 
 
         while (mainWindow.getWindow().isOpen()) {
+            PROFILE_FRAME();
             countTime();
-            handleEventInput();
+            { PROFILE_ZONE("handleEventInput"); handleEventInput(); }
             runScenesFlags(); 
-            resetFlags();
         }
+        PROFILE_REPORT();
         log_info("\tGame Ended\n"); 
             
     } catch (const std::exception& e) {
@@ -30,12 +43,68 @@ void GameManager::runGame() {
     }
 }
 
+/* runHeadless advances simulated time by exactly one fixed step per iteration instead of reading the clock, so a run with the 
+same script always plays out the same way and goes as fast as the simulation allows */
+void GameManager::runHeadless(unsigned int steps) {
+    try {
+        loadScenes(); 
+
+        Timer runTimer; 
+        unsigned int step = 0; 
+        for (; step < steps; ++step) {
+            PROFILE_FRAME();
+            handleScriptedInput(step); 
+            if (FlagSystem::flagEvents.gameEnd) break; 
+
+            MetaComponents::frameAccumulator += Constants::FIXED_TIMESTEP; 
+            runScenesFlags(); 
+        }
+
+        float seconds = runTimer.Elapsed(); 
+        log_info("\tHeadless run: " + std::to_string(step) + " steps in " + std::to_string(seconds) + "s (" + 
+                 std::to_string(seconds > 0.0f ? step / seconds : 0.0f) + " steps/s)"); 
+        PROFILE_REPORT();
+        log_info("\tGame Ended\n"); 
+
+    } catch (const std::exception& e) {
+        log_error("Exception in runHeadless: " + std::string(e.what())); 
+    }
+}
+
+Scene* GameManager::getActiveScene(){
+    if(FlagSystem::flagEvents.gameEnd) return nullptr;
+
+    if(FlagSystem::gameScene1Flags.sceneStart && !FlagSystem::gameSceneNextFlags.sceneStart) return gameScene.get();
+    if(FlagSystem::gameSceneNextFlags.sceneStart && !FlagSystem::gameSceneNextFlags.sceneEnd) return gameSceneNext.get();
+    return nullptr;
+}
+
+/* runScenesFlags steps the active scene at the fixed timestep until the accumulated frame time is used up, then draws it 
+once, interpolated between the last two steps. The active scene is picked again every step so scene changes apply right away */
 void GameManager::runScenesFlags(){
-    if(!FlagSystem::flagEvents.gameEnd){
-        if(FlagSystem::gameScene1Flags.sceneStart && !FlagSystem::gameSceneNextFlags.sceneStart) gameScene->runScene();
+    sf::Clock stageClock; // times the steps and the draw for the performance HUD
+    unsigned short steps = 0;
+    while (MetaComponents::frameAccumulator >= Constants::FIXED_TIMESTEP && steps < Constants::MAX_CATCH_UP_STEPS) {
+        Scene* scene = getActiveScene();
+        if (!scene) break;
 
-        if(FlagSystem::gameSceneNextFlags.sceneStart && !FlagSystem::gameSceneNextFlags.sceneEnd) gameSceneNext->runScene();
+        MetaComponents::deltaTime = Constants::FIXED_TIMESTEP;
+        MetaComponents::globalTime += Constants::FIXED_TIMESTEP;
+        scene->stepScene();
+
+        MetaComponents::frameAccumulator -= Constants::FIXED_TIMESTEP;
+        ++steps;
+        resetFlags(); // one-shot input is consumed by the first step
+    }
+
+    // on slow frames drop the time we couldn't catch up on instead of falling further behind every frame
+    if (steps == Constants::MAX_CATCH_UP_STEPS) {
+        MetaComponents::frameAccumulator = std::min(MetaComponents::frameAccumulator, Constants::FIXED_TIMESTEP);
     }
+
+    MetaComponents::simulationTime = stageClock.restart().asSeconds();
+    if (Scene* scene = getActiveScene()) scene->renderScene(MetaComponents::frameAccumulator / Constants::FIXED_TIMESTEP);
+    MetaComponents::drawTime = stageClock.getElapsedTime().asSeconds();
 }
 
 void GameManager::loadScenes(){
@@ -44,63 +113,161 @@ void GameManager::loadScenes(){
     gameSceneNext->createAssets(); 
 }
 
-// countTime counts global time and delta time for scenes to later use in runScene 
+// countTime adds the real frame time to the accumulator; global time and delta time advance in fixed steps in runScenesFlags 
 void GameManager::countTime() {
     sf::Time frameTime = MetaComponents::clock.restart();
-    MetaComponents::deltaTime = frameTime.asSeconds(); 
-    MetaComponents::globalTime += MetaComponents::deltaTime;
+    MetaComponents::frameTime = frameTime.asSeconds();
+    MetaComponents::frameAccumulator += frameTime.asSeconds(); 
 }
 
-/* handleEventInput takes in keyboard and mouse input. It modifies flagEvents and calls setMouseClickedPos in scene to 
-pass in the position in screen where mouse was clicked */
+// handleEventInput passes every pending window event to handleEvent 
 void GameManager::handleEventInput() {
     sf::Event event;
     while (mainWindow.getWindow().pollEvent(event)) {
-        if (event.type == sf::Event::Closed) {
-            log_info("Window close event detected.");
-            FlagSystem::flagEvents.gameEnd = true;
-            mainWindow.getWindow().close();
-            return; 
-        }
-        if (event.type == sf::Event::Resized){ 
-            float aspectRatio = static_cast<float>(event.size.width) / event.size.height;
-            sf::FloatRect visibleArea(0.0f, 0.0f, Constants::VIEW_SIZE_X, Constants::VIEW_SIZE_X / aspectRatio);
-            MetaComponents::view = sf::View(visibleArea); 
-        }
-        if (event.type == sf::Event::KeyPressed) {
-            switch (event.key.code) {
-                case sf::Keyboard::A:
-                    FlagSystem::flagEvents.aPressed = true;
-                    break;
-                case sf::Keyboard::S:
-                    FlagSystem::flagEvents.sPressed = true;
-                    break;
-                case sf::Keyboard::W:
-                    FlagSystem::flagEvents.wPressed = true;
-                    break;
-                case sf::Keyboard::D:
-                    FlagSystem::flagEvents.dPressed = true;
-                    break;
-                case sf::Keyboard::B:
-                    FlagSystem::flagEvents.bPressed = true;
-                    break;
-                case sf::Keyboard::Space:
-                    FlagSystem::flagEvents.spacePressed = true;
-                    break;
-                default:
-                    break;
-            }
-        }
-        if (event.type == sf::Event::KeyReleased){
-            FlagSystem::flagEvents.flagKeyReleased(); // for some reason this can't go inside resetFlags
+        handleEvent(event); 
+        if (FlagSystem::flagEvents.gameEnd) return; 
+    }
+}
+
+void GameManager::handleScriptedInput(unsigned int step) {
+    while (nextScriptedEvent < script.size() && script[nextScriptedEvent].step <= step) {
+        handleEvent(script[nextScriptedEvent++].event); 
+    }
+}
+
+/* handleEvent takes in keyboard and mouse input. It modifies flagEvents and sets the position in the world where the mouse 
+was clicked */
+void GameManager::handleEvent(const sf::Event& event) {
+    if (event.type == sf::Event::Closed) {
+        log_info("Window close event detected.");
+        FlagSystem::flagEvents.gameEnd = true;
+        mainWindow.getWindow().close();
+        return; 
+    }
+    if (event.type == sf::Event::Resized){ 
+        float aspectRatio = static_cast<float>(event.size.width) / event.size.height;
+        sf::FloatRect visibleArea(0.0f, 0.0f, Constants::VIEW_SIZE_X, Constants::VIEW_SIZE_X / aspectRatio);
+        MetaComponents::view = sf::View(visibleArea); 
+    }
+    if (event.type == sf::Event::KeyPressed) {
+        switch (event.key.code) {
+            case sf::Keyboard::A:
+                FlagSystem::flagEvents.aPressed = true;
+                break;
+            case sf::Keyboard::S:
+                FlagSystem::flagEvents.sPressed = true;
+                break;
+            case sf::Keyboard::W:
+                FlagSystem::flagEvents.wPressed = true;
+                break;
+            case sf::Keyboard::D:
+                FlagSystem::flagEvents.dPressed = true;
+                break;
+            case sf::Keyboard::B:
+                FlagSystem::flagEvents.bPressed = true;
+                break;
+            case sf::Keyboard::Space:
+                FlagSystem::flagEvents.spacePressed = true;
+                break;
+            case sf::Keyboard::F3:
+                FlagSystem::flagEvents.hudVisible = !FlagSystem::flagEvents.hudVisible;
+                break;
+            default:
+                break;
         }
-        if (event.type == sf::Event::MouseButtonPressed) {
-            FlagSystem::flagEvents.mouseClicked = true;
-            sf::Vector2f worldPos = mainWindow.getWindow().mapPixelToCoords(sf::Mouse::getPosition(mainWindow.getWindow()), MetaComponents::view);
-            MetaComponents::mouseClickedPosition_i = static_cast<sf::Vector2i>(worldPos);
-            MetaComponents::mouseClickedPosition_f = worldPos; 
+    }
+    if (event.type == sf::Event::KeyReleased){
+        FlagSystem::flagEvents.flagKeyReleased(); // for some reason this can't go inside resetFlags
+    }
+    if (event.type == sf::Event::MouseButtonPressed) {
+        FlagSystem::flagEvents.mouseClicked = true;
+        sf::Vector2f worldPos = screenToWorld(event.mouseButton.x, event.mouseButton.y);
+        MetaComponents::mouseClickedPosition_i = static_cast<sf::Vector2i>(worldPos);
+        MetaComponents::mouseClickedPosition_f = worldPos; 
+    }
+}
+
+// screenToWorld maps a window pixel through the current view; headless has no window size, so the view size in pixels is used 
+sf::Vector2f GameManager::screenToWorld(int screenX, int screenY) {
+    if (!mainWindow.isHeadless()) return mainWindow.getWindow().mapPixelToCoords(sf::Vector2i(screenX, screenY), MetaComponents::view);
+
+    const sf::Vector2f& viewSize = MetaComponents::view.getSize(); 
+    sf::Vector2f viewTopLeft = MetaComponents::view.getCenter() - viewSize / 2.0f; 
+    return sf::Vector2f(viewTopLeft.x + screenX * viewSize.x / Constants::VIEW_SIZE_X, 
+                        viewTopLeft.y + screenY * viewSize.y / Constants::VIEW_SIZE_Y); 
+}
+
+ScriptedEvent scriptedKey(unsigned int step, sf::Keyboard::Key key, bool pressed) {
+    ScriptedEvent scripted{ step, sf::Event() }; 
+    scripted.event.type = pressed ? sf::Event::KeyPressed : sf::Event::KeyReleased; 
+    scripted.event.key.code = key; 
+    return scripted; 
+}
+
+ScriptedEvent scriptedClick(unsigned int step, int screenX, int screenY) {
+    ScriptedEvent scripted{ step, sf::Event() }; 
+    scripted.event.type = sf::Event::MouseButtonPressed; 
+    scripted.event.mouseButton.button = sf::Mouse::Left; 
+    scripted.event.mouseButton.x = screenX; 
+    scripted.event.mouseButton.y = screenY; 
+    return scripted; 
+}
+
+ScriptedEvent scriptedClose(unsigned int step) {
+    ScriptedEvent scripted{ step, sf::Event() }; 
+    scripted.event.type = sf::Event::Closed; 
+    return scripted; 
+}
+
+// a whole word as an integer, false if it has anything else in it or doesn't fit 
+template<typename T>
+static bool parseScriptNumber(const std::string& word, T& value) {
+    auto [end, error] = std::from_chars(word.data(), word.data() + word.size(), value); 
+    return error == std::errc() && end == word.data() + word.size(); 
+}
+
+std::vector<ScriptedEvent> readInputScript(const std::filesystem::path& scriptFile) {
+    static const std::unordered_map<std::string, sf::Keyboard::Key> keys = {
+        {"A", sf::Keyboard::A}, {"B", sf::Keyboard::B}, {"D", sf::Keyboard::D}, {"S", sf::Keyboard::S}, 
+        {"W", sf::Keyboard::W}, {"Space", sf::Keyboard::Space}, {"F3", sf::Keyboard::F3}
+    };
+
+    std::ifstream in(scriptFile); 
+    if (!in) throw std::runtime_error("couldn't open input script " + scriptFile.string()); 
+
+    std::vector<ScriptedEvent> script; 
+    std::string line; 
+    for (size_t lineNumber = 1; std::getline(in, line); ++lineNumber) {
+        line = line.substr(0, line.find('#')); 
+        std::istringstream words(line); 
+        std::vector<std::string> parts{ std::istream_iterator<std::string>(words), std::istream_iterator<std::string>() }; 
+        if (parts.empty()) continue; 
+
+        auto fail = [&](const std::string& problem) {
+            return std::runtime_error(scriptFile.string() + ":" + std::to_string(lineNumber) + ": " + problem); 
+        };
+        unsigned int step = 0; 
+        if (!parseScriptNumber(parts[0], step)) throw fail("\"" + parts[0] + "\" is not a step number"); 
+        const std::string event = parts.size() > 1 ? parts[1] : ""; 
+
+        if ((event == "press" || event == "release") && parts.size() == 3) {
+            auto key = keys.find(parts[2]); 
+            if (key == keys.end()) throw fail("unknown key \"" + parts[2] + "\""); 
+            script.push_back(scriptedKey(step, key->second, event == "press")); 
+        } 
+        else if (event == "click" && parts.size() == 4) {
+            int x = 0, y = 0; 
+            if (!parseScriptNumber(parts[2], x) || !parseScriptNumber(parts[3], y)) throw fail("click needs whole pixel coordinates"); 
+            script.push_back(scriptedClick(step, x, y)); 
+        } 
+        else if (event == "close" && parts.size() == 2) {
+            script.push_back(scriptedClose(step)); 
+        } 
+        else {
+            throw fail("expected press <key>, release <key>, click <x> <y> or close after the step"); 
         }
     }
+    return script; 
 }
 
 void GameManager::resetFlags(){
@@ -9,24 +9,56 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <charconv>
+#include <unordered_map>
 
 #include <SFML/Graphics.hpp>
 
 #include "../scenes/scenes.hpp"
 
+// an input event fed to the game at a given fixed step when running headless, in place of pollEvent 
+struct ScriptedEvent {
+    unsigned int step; 
+    sf::Event event; 
+};
+
+// helpers for building input scripts 
+ScriptedEvent scriptedKey(unsigned int step, sf::Keyboard::Key key, bool pressed = true); 
+ScriptedEvent scriptedClick(unsigned int step, int screenX, int screenY); // screen position in view pixels
+ScriptedEvent scriptedClose(unsigned int step); 
+
+/* readInputScript reads a script file with one event per line: "<step> press <key>", "<step> release <key>", 
+"<step> click <x> <y>" or "<step> close". keys are the ones the game reacts to (A, B, D, S, W, Space, F3), # starts a comment. 
+throws naming the file and line of the first bad line */
+std::vector<ScriptedEvent> readInputScript(const std::filesystem::path& scriptFile); 
+
 class GameManager {
 public:
     GameManager();
+    explicit GameManager(std::vector<ScriptedEvent> inputScript); // headless, no window is opened and input comes from the script 
     void loadScenes(); 
     void runGame();
+    void runHeadless(unsigned int steps); // runs fixed steps back to back without drawing and logs the step rate 
     void runScenesFlags();
     void resetFlags(); 
     
 private:
+    Scene* getActiveScene(); // scene picked by the scene flags, or nullptr 
     void countTime(); // countTime counts time regardless of the scene 
     void handleEventInput(); // handleEventInput taks input from device, such as keyboard, mouse, etc */
+    void handleScriptedInput(unsigned int step); // feeds the script events due at this step 
+    void handleEvent(const sf::Event& event); 
+    sf::Vector2f screenToWorld(int screenX, int screenY); 
 
     GameWindow mainWindow;
+    std::vector<ScriptedEvent> script; // sorted by step 
+    size_t nextScriptedEvent = 0; 
 
     std::unique_ptr<introScene> introScreenScene; 
     std::unique_ptr<gamePlayScene> gameScene;
@@ -4,6 +4,18 @@
 //
 
 #include "globals.hpp"  
+#include "../../test-assets/tiles/tiles.hpp"
+#include "../utils/utils.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <unordered_set>
 
 namespace MetaComponents {
     sf::Clock clock;
@@ -66,6 +78,154 @@ namespace SpriteComponents {
 
 /* constant variables defined here */
 namespace Constants {
+    // worker pool for loadAssets and bitmask generation; made on first use, so it is destroyed (and its workers joined) before the asset globals 
+    static utils::TaskPool& assetPool() {
+        static utils::TaskPool pool;
+        return pool;
+    }
+
+    // images decoded by loadAssets, kept until initialize is done so bitmasks and the atlas are made without reading textures back 
+    static std::unordered_map<const sf::Texture*, sf::Image> sourceImages;
+
+    // the decoded image behind a texture; downloads the texture (once) if loadAssets didn't decode it
+    static const sf::Image& sourceImage(const std::shared_ptr<sf::Texture>& texture) {
+        auto found = sourceImages.find(texture.get());
+        if (found == sourceImages.end()) found = sourceImages.emplace(texture.get(), texture->copyToImage()).first;
+        return found->second;
+    }
+
+    // sizes of the decoded images behind textures that were never uploaded (headless), kept for the whole run
+    static std::unordered_map<const sf::Texture*, sf::Vector2u> headlessTextureSizes;
+
+    sf::Vector2u textureSize(const sf::Texture& texture) {
+        auto found = headlessTextureSizes.find(&texture);
+        return found == headlessTextureSizes.end() ? texture.getSize() : found->second;
+    }
+
+    struct BitmaskCacheHeader {
+        char magic[4]; // "BMSK"
+        std::uint32_t version; 
+        std::uint64_t layout; // hash of the bitmask level layout, masks made with another layout are useless
+        std::uint64_t entryCount; 
+    };
+
+    struct BitmaskCacheEntry {
+        std::uint64_t key; 
+        std::uint64_t offset; // from the start of the file, 8 byte aligned
+        std::uint64_t bytes; 
+    };
+
+    /* BitmaskCache keeps made bitmasks in a file between runs. entries are keyed by a hash of the source image file, the rect, the 
+    threshold and the rows used, so editing an image makes its old masks unreachable. the file is mmapped and cached masks point 
+    straight into the mapping, which processes using the same file share. save() rewrites the file with only the masks used this 
+    run, and only if something changed. the mapping is copy-on-write, so a cached mask written to (bitmasks aren't const) only changes 
+    this process's copy of the page */
+    class BitmaskCache {
+    public:
+        static constexpr std::uint32_t VERSION = 1; 
+
+        explicit BitmaskCache(std::filesystem::path filePath) : filePath(std::move(filePath)) {
+            if (this->filePath.empty()) return;
+            auto file = std::make_shared<utils::MappedFile>(this->filePath, true);
+            if (!*file || file->size() < sizeof(BitmaskCacheHeader)) return;
+
+            BitmaskCacheHeader header;
+            std::memcpy(&header, file->data(), sizeof(header));
+            if (std::memcmp(header.magic, "BMSK", 4) != 0 || header.version != VERSION || header.layout != layoutHash() || 
+                header.entryCount > (file->size() - sizeof(header)) / sizeof(BitmaskCacheEntry)) {
+                LOG_WARNING(Assets, "\tBitmask cache {} is stale or damaged, rebuilding it", this->filePath.string());
+                return;
+            }
+
+            for (std::uint64_t i = 0; i < header.entryCount; ++i) {
+                BitmaskCacheEntry entry;
+                std::memcpy(&entry, file->data() + sizeof(header) + i * sizeof(entry), sizeof(entry));
+                if (entry.offset > file->size() || entry.bytes > file->size() - entry.offset) continue;
+                fileEntries[entry.key] = entry;
+            }
+            mappedFile = std::move(file);
+        }
+
+        // 0 if the source can't be read, in which case nothing is cached for it
+        static std::uint64_t hashSource(const std::filesystem::path& sourceFile) { return utils::hashFile(sourceFile); }
+
+        static std::uint64_t makeKey(std::uint64_t sourceHash, const sf::IntRect& rect, float transparency, int bottomRows) {
+            std::uint32_t transparencyBits;
+            std::memcpy(&transparencyBits, &transparency, sizeof(transparencyBits));
+            std::uint64_t key = sourceHash;
+            for (std::int64_t value : { std::int64_t(rect.left), std::int64_t(rect.top), std::int64_t(rect.width), std::int64_t(rect.height), 
+                                        std::int64_t(transparencyBits), std::int64_t(bottomRows) }) {
+                key = utils::hashSeed(key, static_cast<std::uint64_t>(value));
+            }
+            return key;
+        }
+
+        // the cached mask, or nullptr; the mask keeps the mapping alive
+        std::shared_ptr<sf::Uint8[]> find(std::uint64_t key, size_t bytes) {
+            auto found = fileEntries.find(key);
+            if (found == fileEntries.end() || found->second.bytes != bytes) return nullptr;
+
+            std::shared_ptr<sf::Uint8[]> bitmask(mappedFile, mappedFile->writableData() + found->second.offset);
+            if (usedKeys.insert(key).second) usedEntries.emplace_back(key, bitmask, bytes);
+            return bitmask;
+        }
+
+        void store(std::uint64_t key, const std::shared_ptr<sf::Uint8[]>& bitmask, size_t bytes) {
+            if (!bitmask || !usedKeys.insert(key).second) return;
+            usedEntries.emplace_back(key, bitmask, bytes);
+            stored = true;
+        }
+
+        void save() const {
+            if (filePath.empty() || (!stored && usedEntries.size() == fileEntries.size())) return;
+
+            try {
+                BitmaskCacheHeader header { {'B', 'M', 'S', 'K'}, VERSION, layoutHash(), usedEntries.size() };
+                std::vector<BitmaskCacheEntry> entries;
+                std::uint64_t offset = sizeof(header) + usedEntries.size() * sizeof(BitmaskCacheEntry);
+                for (const auto& [key, bitmask, bytes] : usedEntries) {
+                    entries.push_back(BitmaskCacheEntry{ key, offset, bytes });
+                    offset += (bytes + 7) & ~std::uint64_t(7);
+                }
+
+                // write next to the old file and rename over it; a mapping of the old file stays valid
+                std::filesystem::path tempPath = filePath;
+                tempPath += ".tmp" + std::to_string(::getpid()); // per process, several may rebuild the cache at once
+                {
+                    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+                    if (!out) throw std::runtime_error("couldn't open " + tempPath.string());
+                    const char padding[8] = {};
+                    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(BitmaskCacheEntry));
+                    for (const auto& [key, bitmask, bytes] : usedEntries) {
+                        out.write(reinterpret_cast<const char*>(bitmask.get()), bytes);
+                        out.write(padding, ((bytes + 7) & ~size_t(7)) - bytes);
+                    }
+                    if (!out) throw std::runtime_error("couldn't write " + tempPath.string());
+                }
+                std::filesystem::rename(tempPath, filePath);
+                LOG_INFO(Assets, "\tBitmask cache saved ({} masks)", usedEntries.size());
+            }
+            catch (const std::exception& e) {
+                LOG_WARNING(Assets, "Failed to save bitmask cache: {}", e.what());
+            }
+        }
+
+    private:
+        static std::uint64_t layoutHash() {
+            std::uint64_t hash = utils::hashSeed(BITMASK_LEVELS, 64); // rows are padded to 64 bits
+            for (unsigned int block : BITMASK_LEVEL_BLOCKS) hash = utils::hashSeed(hash, block);
+            return hash;
+        }
+
+        std::filesystem::path filePath; 
+        std::shared_ptr<utils::MappedFile> mappedFile; 
+        std::unordered_map<std::uint64_t, BitmaskCacheEntry> fileEntries; 
+        std::vector<std::tuple<std::uint64_t, std::shared_ptr<sf::Uint8[]>, size_t>> usedEntries; // what save() writes
+        std::unordered_set<std::uint64_t> usedKeys; 
+        bool stored = false; 
+    };
+
     // make random position from upper right corner
     sf::Vector2f makeRandomPosition(){
         float xPos = static_cast<float>(WORLD_WIDTH - std::rand() % static_cast<int>(WORLD_WIDTH / 2));
@@ -105,201 +265,493 @@ namespace Constants {
         return sf::Vector2f{ xPos, yPos };
     }
 
-    void initialize(){
+    void initialize(bool headless){
+        HEADLESS = headless;
         std::srand(static_cast<unsigned int>(std::time(nullptr)));
 
-        readFromYaml(std::filesystem::path("test/test-src/game/globals/config.yaml"));
+        readFromYaml(std::filesystem::path(CONFIG_FILE));
         loadAssets();
         makeRectsAndBitmasks(); 
+        if (ATLAS_ENABLED && !HEADLESS) buildTextureAtlas(); // headless has no uploaded textures to pack
+        sourceImages.clear(); 
+    }
+
+    // settings read from the yaml only to work other constants out from (see deriveConstants)
+    static size_t tilemapStreamingBudgetKb; 
+    static std::string levelGeneratorMode; 
+    static std::array<LogLevel, static_cast<size_t>(LogSubsystem::Count)> logLevels {}; // runtime level per subsystem, see set_log_level
+
+    /* one entry of the config schema: where the value is in the yaml, and how to read it from there and to and from a snapshot. 
+    readFromYaml and the snapshot go through the same schema, so they can't disagree about what a setting is */
+    struct ConfigField {
+        std::string path; // keys separated by dots
+        size_t size; // bytes of the value's type, part of the schema hash
+        bool optional; 
+        std::function<void(const YAML::Node&)> readYaml; 
+        std::function<void(std::string&)> writeSnapshot; 
+        std::function<bool(const unsigned char*&, const unsigned char*)> readSnapshot; 
+        std::function<std::string()> check; // optional, what's wrong with the value read or an empty string
+    };
+
+    template<typename T>
+    static void readConfigValue(const YAML::Node& node, T& target) { target = node.as<T>(); }
+    static void readConfigValue(const YAML::Node& node, std::filesystem::path& target) { target = node.as<std::string>(); }
+    static void readConfigValue(const YAML::Node& node, sf::Vector2f& target) { target = { node["x"].as<float>(), node["y"].as<float>() }; }
+    static void readConfigValue(const YAML::Node& node, sf::Color& target) { target = SpriteComponents::toSfColor(node.as<std::string>()); }
+    static void readConfigValue(const YAML::Node& node, SpriteComponents::Direction& target) { target = SpriteComponents::toDirection(node.as<std::string>()); }
+    static void readConfigValue(const YAML::Node& node, LogLevel& target) {
+        static const std::unordered_map<std::string, LogLevel> levelMap = {
+            {"info", LogLevel::Info},
+            {"warning", LogLevel::Warning},
+            {"error", LogLevel::Error},
+            {"off", LogLevel::Off}
+        };
+        auto it = levelMap.find(node.as<std::string>());
+        if (it == levelMap.end()) throw YAML::Exception(node.Mark(), "expected info, warning, error or off");
+        target = it->second;
+    }
+    template<size_t N>
+    static void readConfigValue(const YAML::Node& node, std::array<bool, N>& target) {
+        if (!node.IsSequence()) throw YAML::Exception(node.Mark(), "expected a list");
+        for (size_t i = 0; i < N; ++i) target[i] = i < node.size() ? node[i].as<bool>() : false; // missing entries are false
     }
 
+    template<typename T>
+    static void writeSnapshotValue(std::string& out, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot values are copied as raw bytes");
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    static void writeSnapshotValue(std::string& out, const std::string& value) {
+        writeSnapshotValue(out, static_cast<std::uint32_t>(value.size()));
+        out.append(value);
+    }
+    static void writeSnapshotValue(std::string& out, const std::filesystem::path& value) { writeSnapshotValue(out, value.string()); }
+
+    template<typename T>
+    static bool readSnapshotValue(const unsigned char*& in, const unsigned char* end, T& value) {
+        if (static_cast<size_t>(end - in) < sizeof(T)) return false;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return true;
+    }
+    static bool readSnapshotValue(const unsigned char*& in, const unsigned char* end, std::string& value) {
+        std::uint32_t length = 0;
+        if (!readSnapshotValue(in, end, length) || static_cast<size_t>(end - in) < length) return false;
+        value.assign(reinterpret_cast<const char*>(in), length);
+        in += length;
+        return true;
+    }
+    static bool readSnapshotValue(const unsigned char*& in, const unsigned char* end, std::filesystem::path& value) {
+        std::string text;
+        if (!readSnapshotValue(in, end, text)) return false;
+        value = text;
+        return true;
+    }
+
+    template<typename T>
+    static ConfigField configField(std::string path, T& target, bool optional = false) {
+        return ConfigField{ std::move(path), sizeof(T), optional,
+            [&target](const YAML::Node& node) { readConfigValue(node, target); },
+            [&target](std::string& out) { writeSnapshotValue(out, target); },
+            [&target](const unsigned char*& in, const unsigned char* end) { return readSnapshotValue(in, end, target); }, nullptr };
+    }
+
+    // a setting whose value also has to pass check, e.g. atLeast(1) for a setting that is divided by
+    template<typename T>
+    static ConfigField checkedField(std::string path, T& target, std::function<std::string(const std::decay_t<T>&)> check, bool optional = false) {
+        ConfigField field = configField(std::move(path), target, optional);
+        field.check = [&target, check = std::move(check)] { return check(target); };
+        return field;
+    }
+
+    // check for configField settings with a lower bound
+    template<typename T>
+    static std::function<std::string(const T&)> atLeast(T minimum) {
+        return [minimum](const T& value) { 
+            return value < minimum ? "must be at least " + std::to_string(minimum) + ", got " + std::to_string(value) : std::string(); 
+        };
+    }
+
+    // every setting read from config.yaml
+    static const std::vector<ConfigField>& configSchema() {
+        static const std::vector<ConfigField> schema {
+            // game display settings
+            configField("world.scale", WORLD_SCALE),
+            configField("world.width", WORLD_WIDTH),
+            configField("world.height", WORLD_HEIGHT),
+            configField("world.frame_limit", FRAME_LIMIT),
+            checkedField("world.fixed_timestep.rate", FIXED_TIMESTEP_RATE, atLeast<unsigned short>(1)), // 0 would make FIXED_TIMESTEP infinite
+            checkedField("world.fixed_timestep.max_catch_up_steps", MAX_CATCH_UP_STEPS, atLeast<unsigned short>(1)), // 0 would never step
+            configField("world.title", GAME_TITLE),
+            configField("world.view.size_x", VIEW_SIZE_X),
+            configField("world.view.size_y", VIEW_SIZE_Y),
+            configField("world.view.initial_center", VIEW_INITIAL_CENTER),
+
+            // score, animation, sprite and text settings
+            configField("score.initial", INITIAL_SCORE),
+            configField("animation.change_time", ANIMATION_CHANGE_TIME),
+            configField("animation.passthrough_offset", PASSTHROUGH_OFFSET),
+            configField("sprite.out_of_bounds_offset", SPRITE_OUT_OF_BOUNDS_OFFSET),
+            configField("sprite.out_of_bounds_adjustment", SPRITE_OUT_OF_BOUNDS_ADJUSTMENT),
+            configField("sprite.player_y_pos_bounds_run", PLAYER_Y_POS_BOUNDS_RUN),
+
+            // background settings
+            configField("background.speed", BACKGROUND_SPEED),
+            configField("background.textures.day_path", BACKGROUNDSPRITE_PATH),
+            configField("background.textures.night_path", BACKGROUNDSPRITE_PATH2),
+            configField("background.position", BACKGROUND_POSITION),
+            configField("background.scale", BACKGROUND_SCALE),
+            configField("background.moving_direction", BACKGROUND_MOVING_DIRECTION),
+
+            // sprite paths and settings
+            configField("sprites.sprite1.path", SPRITE1_PATH),
+            configField("sprites.sprite1.speed", SPRITE1_SPEED),
+            configField("sprites.sprite1.acceleration", SPRITE1_ACCELERATION),
+            configField("sprites.sprite1.jump_acceleration", SPRITE1_JUMP_ACCELERATION),
+            configField("sprites.sprite1.index_max", SPRITE1_INDEXMAX),
+            configField("sprites.sprite1.animation_rows", SPRITE1_ANIMATIONROWS),
+            configField("sprites.sprite1.position", SPRITE1_POSITION),
+            configField("sprites.sprite1.scale", SPRITE1_SCALE),
+
+            configField("sprites.cloudBlue.path", CLOUDBLUE_PATH),
+            configField("sprites.cloudBlue.position", CLOUDBLUE_POSITION),
+            configField("sprites.cloudBlue.scale", CLOUDBLUE_SCALE),
+            configField("sprites.cloudBlue.speed", CLOUDBLUE_SPEED),
+            configField("sprites.cloudBlue.acceleration", CLOUDBLUE_ACCELERATION),
+            configField("sprites.cloudBlue.respawn_time", CLOUDBLUE_INITIAL_RESPAWN_TIME),
+            configField("sprites.cloudBlue.limit", CLOUDBLUE_LIMIT),
+
+            configField("sprites.cloudPurple.path", CLOUDPURPLE_PATH),
+            configField("sprites.cloudPurple.position", CLOUDPURPLE_POSITION),
+            configField("sprites.cloudPurple.respawn_time", CLOUDPURPLE_INITIAL_RESPAWN_TIME),
+            configField("sprites.cloudPurple.limit", CLOUDPURPLE_LIMIT),
+
+            configField("sprites.coin.path", COIN_PATH),
+            configField("sprites.coin.position", COIN_POSITION),
+            configField("sprites.coin.scale", COIN_SCALE),
+            configField("sprites.coin.speed", COIN_SPEED),
+            configField("sprites.coin.acceleration", COIN_ACCELERATION),
+            configField("sprites.coin.respawn_time", COIN_INITIAL_RESPAWN_TIME),
+            configField("sprites.coin.limit", COIN_LIMIT),
+
+            configField("sprites.button1.index_max", BUTTON1_INDEXMAX),
+            configField("sprites.button1.path", BUTTON1_PATH),
+            configField("sprites.button1.position", BUTTON1_POSITION),
+            configField("sprites.button1.scale", BUTTON1_SCALE),
+
+            // tile settings
+            configField("tiles.path", TILES_PATH),
+            checkedField("tiles.rows", TILES_ROWS, atLeast<unsigned short>(1)),
+            checkedField("tiles.columns", TILES_COLUMNS, atLeast<unsigned short>(1)),
+            checkedField("tiles.number", TILES_NUM, [](const unsigned short& number) { // read after tiles.rows and tiles.columns
+                if (number != TILES_NUMBER) return "must be " + std::to_string(TILES_NUMBER) + " (TILES_NUMBER in globals.hpp), got " + std::to_string(number);
+                if (number > TILES_ROWS * TILES_COLUMNS) return "must fit in tiles.rows x tiles.columns (" + std::to_string(TILES_ROWS * TILES_COLUMNS) + ")";
+                return std::string(); }),
+            checkedField("tiles.scale", TILES_SCALE, [](const sf::Vector2f& scale) { 
+                return scale.x > 0.0f && scale.y > 0.0f ? std::string() : "must be above 0 on both axes"; }),
+            checkedField("tiles.tile_width", TILE_WIDTH, atLeast<unsigned short>(1)),
+            checkedField("tiles.tile_height", TILE_HEIGHT, atLeast<unsigned short>(1)),
+            configField("tiles.walkable", TILES_BOOLS, true),
+
+            // bitmask cache and texture atlas settings
+            configField("bitmask_cache.path", BITMASK_CACHE_PATH),
+            configField("atlas.enabled", ATLAS_ENABLED),
+            checkedField("atlas.width", ATLAS_WIDTH, atLeast(1u)),
+            checkedField("atlas.padding", ATLAS_PADDING, [](const unsigned int& padding) { // read after atlas.width
+                return padding < ATLAS_WIDTH || ATLAS_WIDTH == 0 ? std::string() : "must be below atlas.width (" + std::to_string(ATLAS_WIDTH) + ")"; }),
+
+            // tilemap settings
+            configField("tilemap.position", TILEMAP_POSITION),
+            configField("tilemap.width", TILEMAP_WIDTH),
+            configField("tilemap.height", TILEMAP_HEIGHT),
+            configField("tilemap.boundary_offset", TILEMAP_BOUNDARYOFFSET),
+            configField("tilemap.filepath", TILEMAP_FILEPATH),
+            checkedField("tilemap.streaming_budget_kb", tilemapStreamingBudgetKb, [](const size_t& budgetKb) { 
+                // one resident chunk: its tile ids and the four vertices of each cell
+                constexpr size_t chunkKb = (TileMap::CHUNK_SIZE * TileMap::CHUNK_SIZE * (sizeof(std::uint16_t) + 4 * sizeof(sf::Vertex)) + 1023) / 1024;
+                return budgetKb == 0 || budgetKb >= chunkKb ? std::string() : "must be 0 (load the whole map) or at least " + 
+                    std::to_string(chunkKb) + " to hold one chunk, got " + std::to_string(budgetKb); }),
+
+            // level generator settings
+            configField("level_generator.seed", LEVELGEN_SEED),
+            configField("level_generator.mode", levelGeneratorMode),
+            configField("level_generator.threads", LEVELGEN_THREADS),
+            configField("level_generator.noise_scale", LEVELGEN_NOISE_SCALE),
+            configField("level_generator.octaves", LEVELGEN_OCTAVES),
+            configField("level_generator.surface_height", LEVELGEN_SURFACE_HEIGHT),
+            configField("level_generator.amplitude", LEVELGEN_AMPLITUDE),
+            configField("level_generator.air_tile", LEVELGEN_AIR_TILE),
+            configField("level_generator.surface_tile", LEVELGEN_SURFACE_TILE),
+            configField("level_generator.ground_tile", LEVELGEN_GROUND_TILE),
+
+            // text settings
+            configField("text.size", TEXT_SIZE),
+            configField("text.font_path", TEXT_PATH),
+            configField("text.message", TEXT_MESSAGE),
+            configField("text.position", TEXT_POSITION),
+            configField("text.color", TEXT_COLOR),
+
+            configField("score_text.size", SCORETEXT_SIZE),
+            configField("score_text.message", SCORETEXT_MESSAGE),
+            configField("score_text.position", SCORETEXT_POSITION),
+            configField("score_text.color", SCORETEXT_COLOR),
+
+            configField("ending_text.size", ENDINGTEXT_SIZE),
+            configField("ending_text.message", ENDINGTEXT_MESSAGE),
+            configField("ending_text.position", ENDINGTEXT_POSITION),
+            configField("ending_text.color", ENDINGTEXT_COLOR),
+
+            configField("hud_text.size", HUDTEXT_SIZE),
+            configField("hud_text.position", HUDTEXT_POSITION),
+            configField("hud_text.color", HUDTEXT_COLOR),
+            configField("hud_text.refresh_time", HUD_REFRESH_TIME),
+
+            // music and sound settings
+            configField("music.background_music.path", BACKGROUNDMUSIC_PATH),
+            configField("music.background_music.volume", BACKGROUNDMUSIC_VOLUME),
+            configField("music.background_music.loop", BACKGROUNDMUSIC_LOOP),
+            configField("music.background_music.ending_volume", BACKGROUNDMUSIC_ENDINGVOLUME),
+
+            configField("sound.player_jump.path", PLAYERJUMPSOUND_PATH),
+            configField("sound.player_jump.volume", PLAYERJUMPSOUND_VOLUME),
+            configField("sound.coin_hit.path", COINHITSOUND_PATH),
+            configField("sound.coin_hit.volume", COINHITSOUND_VOLUME),
+            configField("sound.button_click.path", BUTTONCLICKSOUND_PATH),
+            configField("sound.button_click.volume", BUTTONCLICKSOUND_VOLUME),
+
+            // log levels, optional so a config without them logs everything
+            configField("logging.physics", logLevels[static_cast<size_t>(LogSubsystem::Physics)], true),
+            configField("logging.sprites", logLevels[static_cast<size_t>(LogSubsystem::Sprites)], true),
+            configField("logging.tiles", logLevels[static_cast<size_t>(LogSubsystem::Tiles)], true),
+            configField("logging.scenes", logLevels[static_cast<size_t>(LogSubsystem::Scenes)], true),
+            configField("logging.assets", logLevels[static_cast<size_t>(LogSubsystem::Assets)], true),
+        };
+        return schema;
+    }
+
+    // changes whenever a setting is added, removed, renamed or changes type, so older snapshots are ignored
+    static std::uint64_t configSchemaHash() {
+        std::uint64_t hash = CONFIG_SNAPSHOT_VERSION;
+        for (const auto& field : configSchema()) {
+            for (char c : field.path) hash = utils::hashSeed(hash, static_cast<unsigned char>(c));
+            hash = utils::hashSeed(hash, field.size);
+        }
+        return hash;
+    }
+
+    // the node at a dotted path, or an undefined node if any key on the way is missing
+    static YAML::Node findConfigNode(const YAML::Node& root, const std::string& path) {
+        YAML::Node node(root); // a handle to the same node, reset() below rebinds it without copying
+        size_t begin = 0;
+        while (begin <= path.size()) {
+            size_t dot = std::min(path.find('.', begin), path.size());
+            const YAML::Node& parent = node; // const lookups never add the key
+            if (!parent.IsMap()) return YAML::Node(YAML::NodeType::Undefined);
+            YAML::Node child = parent[path.substr(begin, dot - begin)];
+            if (!child) return YAML::Node(YAML::NodeType::Undefined);
+            node.reset(child);
+            begin = dot + 1;
+        }
+        return node;
+    }
+
+    // values worked out from other settings; run after the settings are read from either the yaml or a snapshot
+    static void deriveConstants() {
+        FIXED_TIMESTEP = 1.0f / FIXED_TIMESTEP_RATE;
+        VIEW_RECT = { 0.0f, 0.0f, VIEW_SIZE_X, VIEW_SIZE_Y };
+        TILEMAP_STREAMING_BUDGET = tilemapStreamingBudgetKb * 1024;
+        LEVELGEN_NOISE = levelGeneratorMode == "noise";
+        for (size_t i = 0; i < logLevels.size(); ++i) set_log_level(static_cast<LogSubsystem>(i), logLevels[i]);
+    }
+
+    struct ConfigSnapshotHeader {
+        char magic[4]; // "CFGS"
+        std::uint32_t version; 
+        std::uint64_t yamlHash; // hash of the config file the snapshot was made from
+        std::uint64_t schemaHash; 
+        std::uint64_t payloadBytes; 
+    };
+
+    static bool readConfigSnapshot(const std::filesystem::path& snapshotFile, std::uint64_t yamlHash) {
+        utils::MappedFile file(snapshotFile);
+        if (!file || file.size() < sizeof(ConfigSnapshotHeader)) return false;
+
+        ConfigSnapshotHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, "CFGS", 4) != 0 || header.version != CONFIG_SNAPSHOT_VERSION || header.yamlHash != yamlHash || 
+            header.schemaHash != configSchemaHash() || header.payloadBytes != file.size() - sizeof(header)) return false;
+
+        const unsigned char* in = file.data() + sizeof(header);
+        const unsigned char* end = file.data() + file.size();
+        for (const auto& field : configSchema()) {
+            if (!field.readSnapshot(in, end)) return false; // the yaml is read again, which overwrites anything read so far
+        }
+        for (const auto& field : configSchema()) {
+            if (field.check && !field.check().empty()) return false; // a snapshot older than the check, the yaml read reports it
+        }
+        return in == end;
+    }
+
+    static void writeConfigSnapshot(const std::filesystem::path& snapshotFile, std::uint64_t yamlHash) {
+        try {
+            std::string payload;
+            for (const auto& field : configSchema()) field.writeSnapshot(payload);
+            ConfigSnapshotHeader header { {'C', 'F', 'G', 'S'}, CONFIG_SNAPSHOT_VERSION, yamlHash, configSchemaHash(), payload.size() };
+
+            std::filesystem::path tempPath = snapshotFile;
+            tempPath += ".tmp" + std::to_string(::getpid()); // per process, several may write the snapshot at once
+            {
+                std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                out.write(payload.data(), payload.size());
+                if (!out) throw std::runtime_error("couldn't write " + tempPath.string());
+            }
+            std::filesystem::rename(tempPath, snapshotFile); // a run reading the old snapshot at the same time keeps its copy
+        }
+        catch (const std::exception& e) {
+            log_warning("Failed to write config snapshot: " + std::string(e.what()));
+        }
+    }
+
+    // collects every key no setting in the schema reads, e.g. a setting written under the wrong section
+    static void findUnknownKeys(const YAML::Node& node, const std::string& path, std::vector<std::string>& unknownKeys) {
+        for (const auto& entry : node) {
+            std::string key = path.empty() ? entry.first.as<std::string>() : path + "." + entry.first.as<std::string>();
+            bool isSetting = false;
+            bool isSection = false;
+            for (const auto& field : configSchema()) {
+                if (field.path == key) isSetting = true;
+                else if (field.path.compare(0, key.size() + 1, key + ".") == 0) isSection = true;
+            }
+            if (isSetting) continue; // read as a whole, e.g. the x and y of a position
+            if (!isSection) unknownKeys.push_back(key);
+            else if (entry.second.IsMap()) findUnknownKeys(entry.second, key, unknownKeys);
+        }
+    }
+
+    /* readFromYaml loads the snapshot next to the config file when it was made from this exact file (same contents hash) and 
+    the same schema. otherwise it parses the yaml, checks every setting in the schema, reports all missing, invalid or out of range ones 
+    together and throws, so the game doesn't start on a half read config. keys the game doesn't read are only warned about. 
+    a new snapshot is written when there were no problems */
     void readFromYaml(const std::filesystem::path configFile) {
+        std::filesystem::path snapshotFile = configFile;
+        snapshotFile += CONFIG_SNAPSHOT_EXTENSION;
+        std::uint64_t yamlHash = utils::hashFile(configFile);
+
+        if (yamlHash && readConfigSnapshot(snapshotFile, yamlHash)) {
+            deriveConstants();
+            log_info("Read config snapshot");
+            return;
+        }
+
+        std::vector<std::string> problems;
         try{ 
             YAML::Node config = YAML::LoadFile(configFile);
 
-            // Load game display settings
-            WORLD_SCALE = config["world"]["scale"].as<float>();
-            WORLD_WIDTH = config["world"]["width"].as<unsigned short>();
-            WORLD_HEIGHT = config["world"]["height"].as<unsigned short>();
-            FRAME_LIMIT = config["world"]["frame_limit"].as<unsigned short>();
-            GAME_TITLE = config["world"]["title"].as<std::string>();
-            VIEW_SIZE_X = config["world"]["view"]["size_x"].as<float>();
-            VIEW_SIZE_Y = config["world"]["view"]["size_y"].as<float>();
-            VIEW_INITIAL_CENTER = {config["world"]["view"]["initial_center"]["x"].as<float>(),
-                                config["world"]["view"]["initial_center"]["y"].as<float>()};
-            VIEW_RECT = { 0.0f, 0.0f, VIEW_SIZE_X, VIEW_SIZE_Y };
-
-            // Load score settings
-            INITIAL_SCORE = config["score"]["initial"].as<unsigned short>(); 
-
-            // Load animation settings
-            ANIMATION_CHANGE_TIME = config["animation"]["change_time"].as<float>();
-            PASSTHROUGH_OFFSET = config["animation"]["passthrough_offset"].as<short>();
-
-            // Load sprite and text settings
-            SPRITE_OUT_OF_BOUNDS_OFFSET = config["sprite"]["out_of_bounds_offset"].as<unsigned short>();
-            SPRITE_OUT_OF_BOUNDS_ADJUSTMENT = config["sprite"]["out_of_bounds_adjustment"].as<unsigned short>();
-            PLAYER_Y_POS_BOUNDS_RUN = config["sprite"]["player_y_pos_bounds_run"].as<unsigned short>();
-
-            // Load background settings
-            BACKGROUND_SPEED = config["background"]["speed"].as<float>();
-            BACKGROUNDSPRITE_PATH = config["background"]["textures"]["day_path"].as<std::string>();
-            BACKGROUNDSPRITE_PATH2 = config["background"]["textures"]["night_path"].as<std::string>();
-            BACKGROUND_POSITION = {config["background"]["position"]["x"].as<float>(),
-                                config["background"]["position"]["y"].as<float>()};
-            BACKGROUND_SCALE = {config["background"]["scale"]["x"].as<float>(),
-                                config["background"]["scale"]["y"].as<float>()};
-            BACKGROUND_MOVING_DIRECTION = SpriteComponents::toDirection(config["background"]["moving_direction"].as<std::string>());
-
-            // Load sprite paths and settings
-            SPRITE1_PATH = config["sprites"]["sprite1"]["path"].as<std::string>();
-            SPRITE1_SPEED = config["sprites"]["sprite1"]["speed"].as<float>();
-            SPRITE1_ACCELERATION = {config["sprites"]["sprite1"]["acceleration"]["x"].as<float>(),
-                                config["sprites"]["sprite1"]["acceleration"]["y"].as<float>()};   
-            SPRITE1_JUMP_ACCELERATION = {config["sprites"]["sprite1"]["jump_acceleration"]["x"].as<float>(),
-                                config["sprites"]["sprite1"]["jump_acceleration"]["y"].as<float>()};           
-            SPRITE1_INDEXMAX = config["sprites"]["sprite1"]["index_max"].as<short>();
-            SPRITE1_ANIMATIONROWS = config["sprites"]["sprite1"]["animation_rows"].as<short>();
-            SPRITE1_POSITION = {config["sprites"]["sprite1"]["position"]["x"].as<float>(),
-                                config["sprites"]["sprite1"]["position"]["y"].as<float>()};
-            SPRITE1_SCALE = {config["sprites"]["sprite1"]["scale"]["x"].as<float>(),
-                            config["sprites"]["sprite1"]["scale"]["y"].as<float>()};
-
-            // Cloud (blue) settings
-            CLOUDBLUE_PATH = config["sprites"]["cloudBlue"]["path"].as<std::string>();
-            CLOUDBLUE_POSITION = {config["sprites"]["cloudBlue"]["position"]["x"].as<float>(),
-                                config["sprites"]["cloudBlue"]["position"]["y"].as<float>()};
-            CLOUDBLUE_SCALE = {config["sprites"]["cloudBlue"]["scale"]["x"].as<float>(),
-                            config["sprites"]["cloudBlue"]["scale"]["y"].as<float>()};
-            CLOUDBLUE_SPEED = config["sprites"]["cloudBlue"]["speed"].as<float>();
-            CLOUDBLUE_ACCELERATION= {config["sprites"]["cloudBlue"]["acceleration"]["x"].as<float>(),
-                                config["sprites"]["cloudBlue"]["acceleration"]["y"].as<float>()};
-            CLOUDBLUE_INITIAL_RESPAWN_TIME = config["sprites"]["cloudBlue"]["respawn_time"].as<float>();
-            CLOUDBLUE_LIMIT = config["sprites"]["cloudBlue"]["limit"].as<unsigned short>();
-
-            // Cloud (purple) settings
-            CLOUDPURPLE_PATH = config["sprites"]["cloudPurple"]["path"].as<std::string>();
-            CLOUDPURPLE_POSITION = {config["sprites"]["cloudPurple"]["position"]["x"].as<float>(),
-                                config["sprites"]["cloudPurple"]["position"]["y"].as<float>()};
-            CLOUDPURPLE_LIMIT = config["sprites"]["cloudPurple"]["limit"].as<unsigned short>();
-
-            // Coin settings
-            COIN_PATH = config["sprites"]["coin"]["path"].as<std::string>();
-            COIN_POSITION = {config["sprites"]["coin"]["position"]["x"].as<float>(),
-                            config["sprites"]["coin"]["position"]["y"].as<float>()};
-            COIN_SCALE = {config["sprites"]["coin"]["scale"]["x"].as<float>(),
-                        config["sprites"]["coin"]["scale"]["y"].as<float>()};
-            COIN_SPEED = config["sprites"]["coin"]["speed"].as<float>();
-            COIN_ACCELERATION = {config["sprites"]["coin"]["acceleration"]["x"].as<float>(),
-                                config["sprites"]["coin"]["acceleration"]["y"].as<float>()};
-            COIN_INITIAL_RESPAWN_TIME = config["sprites"]["coin"]["respawn_time"].as<float>();
-            COIN_LIMIT = config["sprites"]["coin"]["limit"].as<unsigned short>();
-
-            // Load button settings
-            BUTTON1_INDEXMAX = config["sprites"]["button1"]["index_max"].as<short>();
-            BUTTON1_PATH = config["sprites"]["button1"]["path"].as<std::string>();
-            BUTTON1_POSITION = {config["sprites"]["button1"]["position"]["x"].as<float>(),
-                                config["sprites"]["button1"]["position"]["y"].as<float>()};
-            BUTTON1_SCALE = {config["sprites"]["button1"]["scale"]["x"].as<float>(),
-                            config["sprites"]["button1"]["scale"]["y"].as<float>()};
-            CLOUDPURPLE_INITIAL_RESPAWN_TIME = config["sprites"]["cloudPurple"]["respawn_time"].as<float>();
-
-            // Load tile settings
-            TILES_PATH = config["tiles"]["path"].as<std::string>();
-            TILES_ROWS = config["tiles"]["rows"].as<unsigned short>();
-            TILES_COLUMNS = config["tiles"]["columns"].as<unsigned short>();
-            TILES_NUM = config["tiles"]["number"].as<unsigned short>();
-            TILES_SCALE = {config["tiles"]["scale"]["x"].as<float>(),
-                        config["tiles"]["scale"]["y"].as<float>()};
-            TILE_WIDTH = config["tiles"]["tile_width"].as<unsigned short>();
-            TILE_HEIGHT = config["tiles"]["tile_height"].as<unsigned short>();
-            if (config["tiles"]["walkable"]) {
-                const YAML::Node& walkableNode = config["tiles"]["walkable"];                
-                for (unsigned short i = 0; i < TILES_NUM; ++i) {
-                    if (walkableNode[i].IsScalar()) {
-                        TILES_BOOLS[i] = walkableNode[i].as<bool>();
-                    } else {
-                        TILES_BOOLS[i] = false;  // Default to false if something goes wrong
-                    }
+            for (const auto& field : configSchema()) {
+                YAML::Node node = findConfigNode(config, field.path);
+                if (!node) {
+                    if (!field.optional) problems.push_back(field.path + " is missing");
+                    continue;
                 }
+                try {
+                    field.readYaml(node);
+                }
+                catch (const YAML::Exception& e) {
+                    problems.push_back(field.path + " has an invalid value (" + e.msg + ")");
+                    continue;
+                }
+                if (!field.check) continue;
+                std::string error = field.check();
+                if (!error.empty()) problems.push_back(field.path + " " + error);
             }
-
-            // Load tilemap settings
-            TILEMAP_POSITION = {config["tilemap"]["position"]["x"].as<float>(),
-                                config["tilemap"]["position"]["y"].as<float>()};
-            TILEMAP_WIDTH = config["tilemap"]["width"].as<size_t>();
-            TILEMAP_HEIGHT = config["tilemap"]["height"].as<size_t>();
-            TILEMAP_BOUNDARYOFFSET = config["tilemap"]["boundary_offset"].as<float>();
-            TILEMAP_FILEPATH = config["tilemap"]["filepath"].as<std::string>();
-
-            // Load text settings
-            TEXT_SIZE = config["text"]["size"].as<unsigned short>();
-            TEXT_PATH = config["text"]["font_path"].as<std::string>();
-            TEXT_MESSAGE = config["text"]["message"].as<std::string>();
-            TEXT_POSITION = {config["text"]["position"]["x"].as<float>(),
-                            config["text"]["position"]["y"].as<float>()};
-            TEXT_COLOR = SpriteComponents::toSfColor(config["text"]["color"].as<std::string>());
-
-            SCORETEXT_SIZE = config["score_text"]["size"].as<unsigned short>();
-            SCORETEXT_MESSAGE = config["score_text"]["message"].as<std::string>();
-            SCORETEXT_POSITION = {config["score_text"]["position"]["x"].as<float>(),
-                                config["score_text"]["position"]["y"].as<float>()};
-            SCORETEXT_COLOR = SpriteComponents::toSfColor(config["score_text"]["color"].as<std::string>());
-
-            ENDINGTEXT_SIZE = config["ending_text"]["size"].as<unsigned short>();
-            ENDINGTEXT_MESSAGE = config["ending_text"]["message"].as<std::string>();
-            ENDINGTEXT_POSITION = {config["ending_text"]["position"]["x"].as<float>(),
-                                config["ending_text"]["position"]["y"].as<float>()};
-            ENDINGTEXT_COLOR = SpriteComponents::toSfColor(config["ending_text"]["color"].as<std::string>());                    
-
-            // Load music settings
-            BACKGROUNDMUSIC_PATH = config["music"]["background_music"]["path"].as<std::string>();
-            BACKGROUNDMUSIC_VOLUME = config["music"]["background_music"]["volume"].as<float>();
-            BACKGROUNDMUSIC_LOOP = config["music"]["background_music"]["loop"].as<bool>();
-            BACKGROUNDMUSIC_ENDINGVOLUME = config["music"]["background_music"]["ending_volume"].as<float>();
-            
-            // Load sound settings
-            PLAYERJUMPSOUND_PATH = config["sound"]["player_jump"]["path"].as<std::string>();
-            PLAYERJUMPSOUND_VOLUME = config["sound"]["player_jump"]["volume"].as<float>();
-
-            COINHITSOUND_PATH = config["sound"]["coin_hit"]["path"].as<std::string>();
-            COINHITSOUND_VOLUME = config["sound"]["coin_hit"]["volume"].as<float>();
-
-            BUTTONCLICKSOUND_PATH = config["sound"]["button_click"]["path"].as<std::string>();
-            BUTTONCLICKSOUND_VOLUME = config["sound"]["button_click"]["volume"].as<float>();
-            
-            log_info("Succesfuly read yaml file");
+            std::vector<std::string> unknownKeys;
+            if (config.IsMap()) findUnknownKeys(config, "", unknownKeys);
+            for (const auto& key : unknownKeys) log_warning("Config warning: " + key + " is not a known setting, it is ignored");
+            deriveConstants();
         } 
         catch (const YAML::BadFile& e) {
-            log_error("Failed to load config file: " + std::string(e.what()));
+            problems.push_back("couldn't load " + configFile.string() + " (" + e.what() + ")");
         } 
         catch (const YAML::Exception& e) {
-            log_error("YAML parsing error: " + std::string(e.what()));
+            problems.push_back("couldn't parse " + configFile.string() + " (" + e.what() + ")");
         }
 
+        if (!problems.empty()) {
+            for (const auto& problem : problems) log_error("Config error: " + problem);
+            throw std::runtime_error(std::to_string(problems.size()) + " error(s) in " + configFile.string());
+        }
+        if (yamlHash) writeConfigSnapshot(snapshotFile, yamlHash);
+        log_info("Succesfuly read yaml file");
     }
 
+    /* loadAssets decodes every image, sound and the font on a worker pool, so loading takes about as long as the slowest asset 
+    instead of the sum. textures are uploaded here on the main thread as their images finish decoding (headless only keeps their 
+    sizes, see textureSize). sounds and the font keep loading after it returns; SOUNDS_LOADED and FONT_LOADED are ready once they are done */
     void loadAssets(){  // load all sprites textures and stuff across scenes 
+        Timer loadTimer; 
+        utils::TaskPool& pool = assetPool();
+
         // sprites
-        if (!BACKGROUND_TEXTURE->loadFromFile(BACKGROUNDSPRITE_PATH)) log_warning("Failed to load background texture");
-        if (!BACKGROUND_TEXTURE2->loadFromFile(BACKGROUNDSPRITE_PATH2)) log_warning("Failed to load background2 texture");
-        if (!BUTTON1_TEXTURE->loadFromFile(BUTTON1_PATH)) log_warning("Failed to load button texture");
-        if (!SPRITE1_TEXTURE->loadFromFile(SPRITE1_PATH)) log_warning("Failed to load sprite1 texture");
-        if (!TILES_TEXTURE->loadFromFile(TILES_PATH)) log_warning("Failed to load tiles texture");
-        if (!CLOUDBLUE_TEXTURE->loadFromFile(CLOUDBLUE_PATH)) log_warning("Failed to load blue cloud texture");
-        if (!CLOUDPURPLE_TEXTURE->loadFromFile(CLOUDPURPLE_PATH)) log_warning("Failed to load purple cloud texture");
-        if (!COIN_TEXTURE->loadFromFile(COIN_PATH)) log_warning("Failed to load coin texture");
-        
-        // music
-        if (!BACKGROUNDMUSIC_MUSIC->openFromFile(BACKGROUNDMUSIC_PATH)) log_warning("Failed to load background music");
+        struct PendingTexture {
+            std::shared_ptr<sf::Texture>* texture; 
+            std::string name; 
+            std::future<sf::Image> image; 
+        };
+        std::vector<PendingTexture> pendingTextures;
+        auto loadTexture = [&pool, &pendingTextures](std::shared_ptr<sf::Texture>& texture, const std::filesystem::path& path, std::string name) {
+            pendingTextures.push_back(PendingTexture{ &texture, std::move(name), pool.submit([path] {
+                sf::Image image;
+                image.loadFromFile(path);
+                return image;
+            }) });
+        };
+        loadTexture(BACKGROUND_TEXTURE, BACKGROUNDSPRITE_PATH, "background");
+        loadTexture(BACKGROUND_TEXTURE2, BACKGROUNDSPRITE_PATH2, "background2");
+        loadTexture(BUTTON1_TEXTURE, BUTTON1_PATH, "button");
+        loadTexture(SPRITE1_TEXTURE, SPRITE1_PATH, "sprite1");
+        loadTexture(TILES_TEXTURE, TILES_PATH, "tiles");
+        loadTexture(CLOUDBLUE_TEXTURE, CLOUDBLUE_PATH, "blue cloud");
+        loadTexture(CLOUDPURPLE_TEXTURE, CLOUDPURPLE_PATH, "purple cloud");
+        loadTexture(COIN_TEXTURE, COIN_PATH, "coin");
 
         // sounds
-        if (!PLAYERJUMP_SOUNDBUFF->loadFromFile(PLAYERJUMPSOUND_PATH)) log_warning("Failed to load player jump sound");
-        if (!COINHIT_SOUNDBUFF->loadFromFile(COINHITSOUND_PATH)) log_warning("Failed to load coin hit sound");
-        if (!BUTTONCLICK_SOUNDBUFF->loadFromFile(BUTTONCLICKSOUND_PATH)) log_warning("Failed to load button click sound");
-        
+        auto loadSound = [&pool](std::shared_ptr<sf::SoundBuffer> buffer, std::filesystem::path path, std::string name) {
+            return pool.submit([buffer, path, name] {
+                if (!buffer->loadFromFile(path)) LOG_WARNING(Assets, "Failed to load {} sound", name);
+            }).share();
+        };
+        std::vector<std::shared_future<void>> sounds {
+            loadSound(PLAYERJUMP_SOUNDBUFF, PLAYERJUMPSOUND_PATH, "player jump"),
+            loadSound(COINHIT_SOUNDBUFF, COINHITSOUND_PATH, "coin hit"),
+            loadSound(BUTTONCLICK_SOUNDBUFF, BUTTONCLICKSOUND_PATH, "button click")
+        };
+        SOUNDS_LOADED = std::async(std::launch::deferred, [sounds] { for (const auto& sound : sounds) sound.wait(); }).share();
+
         // font
-        if (!TEXT_FONT->loadFromFile(TEXT_PATH)) log_warning("Failed to load text font");
+        FONT_LOADED = pool.submit([font = TEXT_FONT, path = TEXT_PATH] {
+            if (!font->loadFromFile(path)) LOG_WARNING(Assets, "Failed to load text font");
+        }).share();
+
+        // music only opens the file here, it's streamed while playing
+        if (!BACKGROUNDMUSIC_MUSIC->openFromFile(BACKGROUNDMUSIC_PATH)) LOG_WARNING(Assets, "Failed to load background music");
+
+        // upload textures in the order their images finish decoding
+        while (!pendingTextures.empty()) {
+            auto ready = std::find_if(pendingTextures.begin(), pendingTextures.end(), [](const PendingTexture& pending) {
+                return pending.image.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            });
+            if (ready == pendingTextures.end()) {
+                pendingTextures.front().image.wait_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            const sf::Image& image = sourceImages[ready->texture->get()] = ready->image.get();
+            if (HEADLESS) headlessTextureSizes[ready->texture->get()] = image.getSize(); 
+            else if (!(*ready->texture)->loadFromImage(image)) LOG_WARNING(Assets, "Failed to load {} texture", ready->name);
+            pendingTextures.erase(ready);
+        }
+
+        loadTimer.End("\tTextures loaded on " + std::to_string(pool.getThreadCount()) + " threads");
     }
 
     void makeRectsAndBitmasks(){
@@ -317,18 +769,40 @@ namespace Constants {
             BUTTON1_ANIMATIONRECTS.emplace_back(sf::IntRect{ 170 * i, 0, 170, 170 }); 
         }
 
-        BUTTON1_BITMASK.reserve(BUTTON1_INDEXMAX); 
+        // bitmasks come from the cache when their source file, rect and settings match; only the missing ones are made
+        BitmaskCache cache(BITMASK_CACHE_PATH);
+        auto cachedBitmasks = [&cache](const std::shared_ptr<sf::Texture>& texture, const std::filesystem::path& source, 
+                                       const std::vector<sf::IntRect>& rects, int bottomRows = 0) {
+            std::uint64_t sourceHash = BITMASK_CACHE_PATH.empty() ? 0 : BitmaskCache::hashSource(source);
+            std::vector<std::shared_ptr<sf::Uint8[]>> bitmasks(rects.size());
+            std::vector<size_t> missing;
+            for (size_t i = 0; i < rects.size(); ++i) {
+                size_t bytes = bitmaskTotalBytes(rects[i].width, rects[i].height);
+                if (sourceHash) bitmasks[i] = cache.find(BitmaskCache::makeKey(sourceHash, rects[i], 0.0f, bottomRows), bytes);
+                if (!bitmasks[i]) missing.push_back(i);
+            }
+            if (missing.empty()) return bitmasks;
+
+            std::vector<sf::IntRect> missingRects;
+            for (size_t i : missing) missingRects.push_back(rects[i]);
+            std::vector<std::shared_ptr<sf::Uint8[]>> made = createBitmasks(sourceImage(texture), missingRects, 0.0f, bottomRows);
+            for (size_t m = 0; m < missing.size(); ++m) {
+                const sf::IntRect& rect = rects[missing[m]];
+                bitmasks[missing[m]] = made[m];
+                if (sourceHash) cache.store(BitmaskCache::makeKey(sourceHash, rect, 0.0f, bottomRows), made[m], bitmaskTotalBytes(rect.width, rect.height));
+            }
+            return bitmasks;
+        };
+
         // make bitmasks
-        for (const auto& rect : BUTTON1_ANIMATIONRECTS ) {
-            BUTTON1_BITMASK.emplace_back(createBitmask(BUTTON1_TEXTURE, rect));
-        }
+        BUTTON1_BITMASK = cachedBitmasks(BUTTON1_TEXTURE, BUTTON1_PATH, BUTTON1_ANIMATIONRECTS);
         
         CLOUDBLUE_RECT = sf::IntRect{ 0, 0, 205, 116 }; 
-        CLOUDBLUE_BITMASK = createBitmask(CLOUDBLUE_TEXTURE, CLOUDBLUE_RECT);
+        CLOUDBLUE_BITMASK = cachedBitmasks(CLOUDBLUE_TEXTURE, CLOUDBLUE_PATH, { CLOUDBLUE_RECT }).front();
         CLOUDPURPLE_RECT = sf::IntRect{ 0, 0, 205, 116 }; 
-        CLOUDPURPLE_BITMASK = createBitmask(CLOUDPURPLE_TEXTURE, CLOUDPURPLE_RECT);
+        CLOUDPURPLE_BITMASK = cachedBitmasks(CLOUDPURPLE_TEXTURE, CLOUDPURPLE_PATH, { CLOUDPURPLE_RECT }).front();
         COIN_RECT = sf::IntRect{ 0, 0, 20, 20 };
-        COIN_BITMASK = createBitmask(COIN_TEXTURE, COIN_RECT);
+        COIN_BITMASK = cachedBitmasks(COIN_TEXTURE, COIN_PATH, { COIN_RECT }).front();
 
         TILES_SINGLE_RECTS.reserve(TILES_NUMBER); 
         // Populate individual tile rectangles
@@ -338,140 +812,266 @@ namespace Constants {
             }
         }
 
-        TILES_BITMASKS.reserve(TILES_NUMBER); 
         // make bitmasks for tiles 
-        for (const auto& rect : TILES_SINGLE_RECTS ) {
-            TILES_BITMASKS.emplace_back(createBitmask(TILES_TEXTURE, rect));
-        }
+        TILES_BITMASKS = cachedBitmasks(TILES_TEXTURE, TILES_PATH, TILES_SINGLE_RECTS);
 
-        SPRITE1_BITMASK.reserve(SPRITE1_INDEXMAX); 
-        // make bitmasks for tiles 
-        for (const auto& rect : SPRITE1_ANIMATIONRECTS ) {
-            SPRITE1_BITMASK.emplace_back(createBitmaskForBottom(SPRITE1_TEXTURE, rect, 0, 3));
-        }
+        // make bitmasks for the player, only its bottom rows collide 
+        SPRITE1_BITMASK = cachedBitmasks(SPRITE1_TEXTURE, SPRITE1_PATH, SPRITE1_ANIMATIONRECTS, 3);
+        cache.save();
         
         log_info("\tConstants initialized ");
     }
 
+    /* buildTextureAtlas packs the button, player, tile, cloud and coin textures into ATLAS_TEXTURE, points their texture pointers 
+    at it and moves their rects to atlas coordinates, so sprites sharing the atlas can be batched into one draw call. it runs after 
+    makeRectsAndBitmasks, so the bitmasks are still made from the original textures. backgrounds keep their own textures; they are 
+    drawn whole and are bigger than the rest put together */
+    void buildTextureAtlas() {
+        struct AtlasEntry {
+            std::shared_ptr<sf::Texture>* texture; 
+            std::vector<sf::IntRect*> rects; 
+        };
+
+        std::vector<AtlasEntry> entries;
+        auto addEntry = [&entries](std::shared_ptr<sf::Texture>& texture, std::vector<sf::IntRect*> rects) {
+            entries.push_back(AtlasEntry{ &texture, std::move(rects) });
+        };
+        auto rectPointers = [](std::vector<sf::IntRect>& rects) {
+            std::vector<sf::IntRect*> pointers;
+            pointers.reserve(rects.size());
+            for (auto& rect : rects) pointers.push_back(&rect);
+            return pointers;
+        };
+
+        addEntry(BUTTON1_TEXTURE, rectPointers(BUTTON1_ANIMATIONRECTS));
+        addEntry(SPRITE1_TEXTURE, rectPointers(SPRITE1_ANIMATIONRECTS));
+        addEntry(TILES_TEXTURE, rectPointers(TILES_SINGLE_RECTS));
+        addEntry(CLOUDBLUE_TEXTURE, { &CLOUDBLUE_RECT });
+        addEntry(CLOUDPURPLE_TEXTURE, { &CLOUDPURPLE_RECT });
+        addEntry(COIN_TEXTURE, { &COIN_RECT });
+
+        try {
+            std::vector<utils::AtlasSlot> sizes;
+            int atlasWidth = static_cast<int>(ATLAS_WIDTH);
+            for (const auto& entry : entries) {
+                sf::Vector2u size = (*entry.texture)->getSize();
+                if (!size.x || !size.y) throw std::runtime_error("a source texture is empty");
+                sizes.push_back(utils::AtlasSlot{ 0, 0, static_cast<int>(size.x), static_cast<int>(size.y) });
+                atlasWidth = std::max(atlasWidth, static_cast<int>(size.x));
+            }
+
+            int atlasHeight = 0;
+            std::vector<utils::AtlasSlot> slots = utils::packShelves(sizes, atlasWidth, static_cast<int>(ATLAS_PADDING), atlasHeight);
+            unsigned int maximumSize = sf::Texture::getMaximumSize();
+            if (static_cast<unsigned int>(atlasWidth) > maximumSize || static_cast<unsigned int>(atlasHeight) > maximumSize) {
+                throw std::runtime_error("atlas would be " + std::to_string(atlasWidth) + "x" + std::to_string(atlasHeight) + 
+                                         ", the maximum texture size is " + std::to_string(maximumSize));
+            }
+
+            sf::Image atlasImage;
+            atlasImage.create(static_cast<unsigned int>(atlasWidth), static_cast<unsigned int>(atlasHeight), sf::Color::Transparent);
+            for (size_t i = 0; i < entries.size(); ++i) {
+                atlasImage.copy(sourceImage(*entries[i].texture), static_cast<unsigned int>(slots[i].x), static_cast<unsigned int>(slots[i].y));
+            }
+            if (!ATLAS_TEXTURE->loadFromImage(atlasImage)) throw std::runtime_error("failed to upload the atlas texture");
+
+            for (size_t i = 0; i < entries.size(); ++i) {
+                for (sf::IntRect* rect : entries[i].rects) {
+                    rect->left += slots[i].x;
+                    rect->top += slots[i].y;
+                }
+                *entries[i].texture = ATLAS_TEXTURE; 
+            }
+
+            LOG_INFO(Assets, "\tTexture atlas built ({}x{}, {} textures)", atlasWidth, atlasHeight, entries.size());
+        }
+        catch (const std::exception& e) {
+            LOG_WARNING(Assets, "Texture atlas not built, keeping separate textures: {}", e.what());
+        }
+    }
+
+    /* generateTileMap fills rows in parallel bands. every row (uniform mode) or column (noise mode) seeds itself from the level seed 
+    and its own coordinate, so the output doesn't depend on how rows are split between threads */
+    std::vector<std::uint16_t> generateTileMap(size_t width, size_t height, std::uint64_t seed) {
+        std::vector<std::uint16_t> tileIds(width * height); 
+        if (tileIds.empty()) return tileIds; 
+
+        if (LEVELGEN_NOISE && std::max({ LEVELGEN_AIR_TILE, LEVELGEN_SURFACE_TILE, LEVELGEN_GROUND_TILE }) >= TILES_NUMBER) {
+            throw std::out_of_range("Level generator tile ids must be below " + std::to_string(TILES_NUMBER));
+        }
+
+        // ground line per column from fractal noise; cheap, so it's done up front
+        std::vector<size_t> surfaceRows; 
+        if (LEVELGEN_NOISE) {
+            surfaceRows.resize(width); 
+            float scale = std::max(LEVELGEN_NOISE_SCALE, 1.0f); 
+            for (size_t x = 0; x < width; ++x) {
+                float noise = utils::fractalNoise(seed, static_cast<float>(x) / scale, std::max(LEVELGEN_OCTAVES, 1u)); 
+                float surface = (LEVELGEN_SURFACE_HEIGHT + (noise - 0.5f) * 2.0f * LEVELGEN_AMPLITUDE) * static_cast<float>(height); 
+                surfaceRows[x] = static_cast<size_t>(std::clamp(surface, 0.0f, static_cast<float>(height - 1))); 
+            }
+        }
+
+        auto fillRows = [&](size_t firstRow, size_t lastRow) {
+            for (size_t y = firstRow; y < lastRow; ++y) {
+                std::uint16_t* row = &tileIds[y * width]; 
+                if (LEVELGEN_NOISE) {
+                    for (size_t x = 0; x < width; ++x) {
+                        row[x] = y < surfaceRows[x] ? LEVELGEN_AIR_TILE : y == surfaceRows[x] ? LEVELGEN_SURFACE_TILE : LEVELGEN_GROUND_TILE; 
+                    }
+                } else {
+                    utils::Xoshiro256 random(utils::hashSeed(seed, y)); 
+                    for (size_t x = 0; x < width; ++x) row[x] = static_cast<std::uint16_t>(random.nextBelow(TILES_NUMBER)); 
+                }
+            }
+        };
+
+        unsigned int threadCount = LEVELGEN_THREADS > 0 ? LEVELGEN_THREADS : std::max(std::thread::hardware_concurrency(), 1u); 
+        threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, height)); 
+        size_t rowsPerThread = (height + threadCount - 1) / threadCount; 
+
+        std::vector<std::thread> workers; 
+        workers.reserve(threadCount); 
+        for (unsigned int i = 1; i < threadCount; ++i) {
+            size_t firstRow = i * rowsPerThread; 
+            if (firstRow >= height) break; 
+            workers.emplace_back(fillRows, firstRow, std::min(firstRow + rowsPerThread, height)); 
+        }
+        fillRows(0, std::min(rowsPerThread, height)); // this thread takes the first band
+        for (auto& worker : workers) worker.join(); 
+
+        return tileIds; 
+    }
+
+    // writes a generated map as text, or as a binary tile map when the path ends in TileMap::BINARY_EXTENSION. the text is built 
+    // in memory and written with a single write 
     void writeRandomTileMap(const std::filesystem::path filePath) {
         try{
-            std::ofstream fileStream(filePath);
-        
-            if (!fileStream.is_open()) {
-                throw std::runtime_error("Unable to open file: " + filePath.string());
+            std::vector<std::uint16_t> tileIds = generateTileMap(TILEMAP_WIDTH, TILEMAP_HEIGHT, LEVELGEN_SEED); 
+
+            if (filePath.extension() == TileMap::BINARY_EXTENSION) {
+                TileMap::writeBinaryFile(filePath, tileIds, TILEMAP_WIDTH, TILEMAP_HEIGHT, TILE_WIDTH, TILE_HEIGHT); 
+                LOG_INFO(Tiles, "successfuly made a random tile map"); 
+                return; 
             }
 
-            for (unsigned short y = 0; y < TILEMAP_HEIGHT; ++y) {
-                for (unsigned short x = 0; x < TILEMAP_WIDTH; ++x) {
-                    // Generate a random tile index using rand()
-                    unsigned int tileIndex = std::rand() % TILES_NUMBER;
-                    fileStream << tileIndex;
+            std::string text; 
+            text.reserve(tileIds.size() * 3 + TILEMAP_HEIGHT); 
+            char number[8]; 
+            for (size_t y = 0; y < TILEMAP_HEIGHT; ++y) {
+                for (size_t x = 0; x < TILEMAP_WIDTH; ++x) {
+                    char* numberEnd = std::to_chars(number, number + sizeof(number), tileIds[y * TILEMAP_WIDTH + x]).ptr; 
+                    text.append(number, numberEnd); 
 
                     if (x < TILEMAP_WIDTH - 1) { // Avoid adding extra space at the end of the line
-                        fileStream << " ";
+                        text.push_back(' '); 
                     }
                 }
-                fileStream << std::endl; // New line after each row
+                text.push_back('\n'); // New line after each row
+            }
+
+            std::ofstream fileStream(filePath, std::ios::binary);
+            if (!fileStream.is_open()) {
+                throw std::runtime_error("Unable to open file: " + filePath.string());
             }
+            fileStream.write(text.data(), static_cast<std::streamsize>(text.size())); 
             fileStream.close();
 
-            log_info("successfuly made a random tile map"); 
+            LOG_INFO(Tiles, "successfuly made a random tile map"); 
         }
         catch (const std::exception& e){
-            log_warning("Error in writing random tile map: " + std::string(e.what()));
+            LOG_WARNING(Tiles, "Error in writing random tile map: {}", e.what());
         }
     }
 
-    std::shared_ptr<sf::Uint8[]> createBitmask( const std::shared_ptr<sf::Texture>& texture, const sf::IntRect& rect, const float transparency) {
-        if (!texture) {
-            log_warning("\tfailed to create bitmask ( texture is empty )");
-            return nullptr;
-        }
-
-        // Ensure the rect is within the bounds of the texture
-        sf::Vector2u textureSize = texture->getSize();
-        if (rect.left < 0 || rect.top < 0 || 
-            rect.left + rect.width > static_cast<int>(textureSize.x) || 
-            rect.top + rect.height > static_cast<int>(textureSize.y)) {
-            log_warning("\tfailed to create bitmask ( rect is out of bounds)");
+    /* fillBitmask reads the pixels straight from the decoded image, rows [startRow, rect.height) of the rect. a pixel is set if 
+    its alpha passes the transparency threshold, or is above 128 without one */
+    static std::shared_ptr<sf::Uint8[]> fillBitmask(const sf::Image& image, const sf::IntRect& rect, const float transparency, unsigned int startRow) {
+        // Ensure the rect is within the bounds of the image
+        sf::Vector2u imageSize = image.getSize();
+        if (rect.left < 0 || rect.top < 0 || rect.width <= 0 || rect.height <= 0 ||
+            rect.left + rect.width > static_cast<int>(imageSize.x) || 
+            rect.top + rect.height > static_cast<int>(imageSize.y)) {
+            LOG_WARNING(Assets, "\tfailed to create bitmask ( rect is out of bounds)");
             return nullptr;
         }
 
-        sf::Image image = texture->copyToImage();
         unsigned int width = rect.width;
         unsigned int height = rect.height;
+        unsigned int rowBytes = bitmaskRowBytes(width);
+        std::shared_ptr<sf::Uint8[]> bitmask(new sf::Uint8[bitmaskTotalBytes(width, height)](), std::default_delete<sf::Uint8[]>());
 
-        unsigned int bitmaskSize = (width * height) / 8 + ((width * height) % 8 != 0); // rounding up
-        std::shared_ptr<sf::Uint8[]> bitmask(new sf::Uint8[bitmaskSize](), std::default_delete<sf::Uint8[]>());
+        const sf::Uint8* pixels = image.getPixelsPtr(); // RGBA, 4 bytes per pixel
+        sf::Uint8 threshold = transparency > 0.0f ? static_cast<sf::Uint8>(transparency * 255) : 129; 
 
-        for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int y = startRow; y < height; ++y) {
+            const sf::Uint8* row = pixels + (static_cast<size_t>(rect.top + y) * imageSize.x + rect.left) * 4;
+            sf::Uint8* bits = bitmask.get() + static_cast<size_t>(y) * rowBytes;
             for (unsigned int x = 0; x < width; ++x) {
-                sf::Color pixelColor = image.getPixel(rect.left + x, rect.top + y);
-                unsigned int bitIndex = y * width + x;
-                unsigned int byteIndex = bitIndex / 8;
-                unsigned int bitPosition = bitIndex % 8;
-
-                // Use transparency threshold if provided, otherwise default to alpha > 128
-                if ((transparency > 0.0f && pixelColor.a >= static_cast<sf::Uint8>(transparency * 255)) || 
-                    (transparency <= 0.0f && pixelColor.a > 128)) {
-                    bitmask[byteIndex] |= (1 << bitPosition);
-                }
+                if (row[x * 4 + 3] >= threshold) bits[x / 8] |= (1 << (x % 8));
             }
         }
 
+        buildBitmaskLevels(bitmask, width, height);
         return bitmask;
     }
 
-    std::shared_ptr<sf::Uint8[]> createBitmaskForBottom(const std::shared_ptr<sf::Texture>& texture, const sf::IntRect& rect, const float transparency, int rows) {
-        if (!texture) {
-            log_warning("\tfailed to create bitmask ( texture is empty )");
-            return nullptr;
-        }
+    std::shared_ptr<sf::Uint8[]> createBitmask(const sf::Image& image, const sf::IntRect& rect, const float transparency) {
+        return fillBitmask(image, rect, transparency, 0);
+    }
 
-        // Ensure the rect is within the bounds of the texture
-        sf::Vector2u textureSize = texture->getSize();
-        if (rect.left < 0 || rect.top < 0 || 
-            rect.left + rect.width > static_cast<int>(textureSize.x) || 
-            rect.top + rect.height > static_cast<int>(textureSize.y)) {
-            log_warning("\tfailed to create bitmask ( rect is out of bounds)");
-            return nullptr;
+    std::shared_ptr<sf::Uint8[]> createBitmaskForBottom(const sf::Image& image, const sf::IntRect& rect, const float transparency, int rows) {
+        // Start processing only the last selected rows of the rectangle
+        unsigned int startRow = (rect.height >= rows) ? static_cast<unsigned int>(rect.height - rows) : 0;
+        return fillBitmask(image, rect, transparency, startRow);
+    }
+
+    std::vector<std::shared_ptr<sf::Uint8[]>> createBitmasks(const sf::Image& image, const std::vector<sf::IntRect>& rects, const float transparency, int bottomRows) {
+        std::vector<std::future<std::shared_ptr<sf::Uint8[]>>> pending;
+        pending.reserve(rects.size());
+        for (const auto& rect : rects) {
+            pending.push_back(assetPool().submit([&image, rect, transparency, bottomRows] {
+                return bottomRows > 0 ? createBitmaskForBottom(image, rect, transparency, bottomRows) : createBitmask(image, rect, transparency);
+            }));
         }
 
-        sf::Image image = texture->copyToImage();
-        unsigned int width = rect.width;
-        unsigned int height = rect.height;
+        std::vector<std::shared_ptr<sf::Uint8[]>> bitmasks;
+        bitmasks.reserve(rects.size());
+        for (auto& bitmask : pending) bitmasks.push_back(bitmask.get());
+        return bitmasks;
+    }
 
-        unsigned int bitmaskSize = (width * height) / 8 + ((width * height) % 8 != 0); // rounding up
-        std::shared_ptr<sf::Uint8[]> bitmask(new sf::Uint8[bitmaskSize](), std::default_delete<sf::Uint8[]>());
+    // fills the coarse levels of a bitmask; a block bit is set if any bit of the level below it is set 
+    void buildBitmaskLevels(const std::shared_ptr<sf::Uint8[]>& bitmask, unsigned int width, unsigned int height) {
+        for (unsigned int level = 1; level < BITMASK_LEVELS; ++level) {
+            unsigned int ratio = BITMASK_LEVEL_BLOCKS[level] / BITMASK_LEVEL_BLOCKS[level - 1];
 
-        // Start processing only the last selected rows of the rectangle
-        unsigned int startRow = (height >= rows) ? height - rows : 0;
+            unsigned int srcWidth = bitmaskLevelSize(width, level - 1);
+            unsigned int srcHeight = bitmaskLevelSize(height, level - 1);
+            unsigned int srcRowBytes = bitmaskRowBytes(srcWidth);
+            const sf::Uint8* src = bitmask.get() + bitmaskLevelOffset(width, height, level - 1);
 
-        for (unsigned int y = startRow; y < height; ++y) {
-            for (unsigned int x = 0; x < width; ++x) {
-                sf::Color pixelColor = image.getPixel(rect.left + x, rect.top + y);
-                unsigned int bitIndex = y * width + x;
-                unsigned int byteIndex = bitIndex / 8;
-                unsigned int bitPosition = bitIndex % 8;
-
-                // Use transparency threshold if provided, otherwise default to alpha > 128
-                if ((transparency > 0.0f && pixelColor.a >= static_cast<sf::Uint8>(transparency * 255)) || 
-                    (transparency <= 0.0f && pixelColor.a > 128)) {
-                    bitmask[byteIndex] |= (1 << bitPosition);
+            unsigned int dstRowBytes = bitmaskRowBytes(bitmaskLevelSize(width, level));
+            sf::Uint8* dst = bitmask.get() + bitmaskLevelOffset(width, height, level);
+
+            for (unsigned int y = 0; y < srcHeight; ++y) {
+                for (unsigned int x = 0; x < srcWidth; ++x) {
+                    if (src[y * srcRowBytes + x / 8] & (1 << (x % 8))) {
+                        unsigned int blockX = x / ratio;
+                        dst[(y / ratio) * dstRowBytes + blockX / 8] |= (1 << (blockX % 8));
+                    }
                 }
             }
         }
-
-        return bitmask;
     }
+
     void printBitmaskDebug(const std::shared_ptr<sf::Uint8[]>& bitmask, unsigned int width, unsigned int height) {
     std::stringstream bitmaskStream;
 
     for (unsigned int y = 0; y < height; ++y) {
         for (unsigned int x = 0; x < width; ++x) {
-            unsigned int bitIndex = y * width + x;
-            unsigned int byteIndex = bitIndex / 8;
-            int bitPosition = 7 - (bitIndex % 8); // High bit to low bit order
+            unsigned int byteIndex = y * bitmaskRowBytes(width) + x / 8;
+            int bitPosition = x % 8; // same low-bit-first order the bitmasks are built with
 
             if (bitmask[byteIndex] & (1 << bitPosition)) {
                 bitmaskStream << '1';
@@ -482,7 +1082,7 @@ namespace Constants {
         bitmaskStream << std::endl; // Move to the next row
     }
 
-    log_info(bitmaskStream.str());
+    LOG_INFO(Assets, "{}", bitmaskStream.str());
 }
 
 }
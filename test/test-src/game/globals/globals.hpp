@@ -13,6 +13,7 @@
 #include <fstream> 
 #include <yaml-cpp/yaml.h>
 #include <filesystem>
+#include <future>
 
 #include "../test-logging/log.hpp"
 
@@ -28,7 +29,13 @@ namespace MetaComponents{
     inline sf::Vector2f mouseClickedPosition_f {}; 
 
     inline float globalTime {};
-    inline float deltaTime {}; 
+    inline float deltaTime {}; // always the fixed timestep while a scene steps
+    inline float frameAccumulator {}; // real time not yet consumed by fixed steps
+
+    // seconds the last frame took in total, stepping the scene and drawing it (see GameManager::runScenesFlags)
+    inline float frameTime {};
+    inline float simulationTime {};
+    inline float drawTime {};
     inline float spacePressedElapsedTime{};
 
     extern sf::Clock clock;
@@ -42,29 +49,64 @@ namespace MetaComponents{
 }
 
 namespace Constants { // not actually "constants" in terms of being fixed, but should never be altered after being read from the config.yaml file
-    extern void initialize();
+    extern void initialize(bool headless = false); // throws when the config can't be read
+    inline bool HEADLESS {}; // set by initialize; textures are decoded but never uploaded, so no GL context is needed
+    extern sf::Vector2u textureSize(const sf::Texture& texture); // also right when headless, from the decoded image
 
     // make random positions each time
     extern sf::Vector2f makeRandomPosition(); 
     extern sf::Vector2f makeRandomPositionCloud(); 
     extern sf::Vector2f makeRandomPositionCoin(); 
 
+    // tile ids for a width x height map from the level_generator settings; the same seed gives the same map on any thread count
+    extern std::vector<std::uint16_t> generateTileMap(size_t width, size_t height, std::uint64_t seed); 
     extern void writeRandomTileMap(const std::filesystem::path filePath); 
 
-    // load textures, fonts, music, and sound
-    extern std::shared_ptr<sf::Uint8[]> createBitmask( const std::shared_ptr<sf::Texture>& texture, const sf::IntRect& rect, const float transparency = 0.0f);
-    extern std::shared_ptr<sf::Uint8[]> createBitmaskForBottom( const std::shared_ptr<sf::Texture>& texture, const sf::IntRect& rect, const float transparency = 0.0f, int rows = 1);
+    // bitmasks hold one bit per pixel (low bit first), with every row padded to whole 64-bit words 
+    inline unsigned int bitmaskRowWords(unsigned int width) { return (width + 63) / 64; }
+    inline unsigned int bitmaskRowBytes(unsigned int width) { return bitmaskRowWords(width) * 8; }
+
+    // after the full resolution rows each bitmask stores OR-reduced levels, one bit per block of pixels
+    inline constexpr unsigned int BITMASK_LEVELS = 3;
+    inline constexpr unsigned int BITMASK_LEVEL_BLOCKS[BITMASK_LEVELS] = { 1, 8, 64 }; // block size in pixels per level
+    inline unsigned int bitmaskLevelSize(unsigned int pixels, unsigned int level) { return (pixels + BITMASK_LEVEL_BLOCKS[level] - 1) / BITMASK_LEVEL_BLOCKS[level]; }
+    inline size_t bitmaskLevelOffset(unsigned int width, unsigned int height, unsigned int level) {
+        size_t offset = 0;
+        for (unsigned int i = 0; i < level; ++i) offset += static_cast<size_t>(bitmaskRowBytes(bitmaskLevelSize(width, i))) * bitmaskLevelSize(height, i);
+        return offset;
+    }
+    inline size_t bitmaskTotalBytes(unsigned int width, unsigned int height) { return bitmaskLevelOffset(width, height, BITMASK_LEVELS); }
+    extern void buildBitmaskLevels(const std::shared_ptr<sf::Uint8[]>& bitmask, unsigned int width, unsigned int height);
+
+    // bitmasks are made from decoded images, never from textures (that would download the texture from the GPU)
+    extern std::shared_ptr<sf::Uint8[]> createBitmask( const sf::Image& image, const sf::IntRect& rect, const float transparency = 0.0f);
+    extern std::shared_ptr<sf::Uint8[]> createBitmaskForBottom( const sf::Image& image, const sf::IntRect& rect, const float transparency = 0.0f, int rows = 1);
+    // one bitmask per rect, made in parallel on the asset pool; bottomRows above 0 uses createBitmaskForBottom
+    extern std::vector<std::shared_ptr<sf::Uint8[]>> createBitmasks( const sf::Image& image, const std::vector<sf::IntRect>& rects, const float transparency = 0.0f, int bottomRows = 0);
 
+    // load textures, fonts, music, and sound
     extern void printBitmaskDebug(const std::shared_ptr<sf::Uint8[]>& bitmask, unsigned int width, unsigned int height);
     extern void loadAssets(); 
-    extern void readFromYaml(const std::filesystem::path configFile); 
+
+    // handles for assets loadAssets leaves loading in the background; wait on them before using the assets
+    inline std::shared_future<void> SOUNDS_LOADED; // PLAYERJUMP, COINHIT and BUTTONCLICK sound buffers
+    inline std::shared_future<void> FONT_LOADED; // TEXT_FONT
+    inline void waitForAsset(const std::shared_future<void>& asset) { if (asset.valid()) asset.wait(); }
+    extern void readFromYaml(const std::filesystem::path configFile); // throws after logging every config error
+    inline constexpr const char* CONFIG_FILE = "test/test-src/game/globals/config.yaml"; // relative to where the game is run from
+    inline constexpr std::uint32_t CONFIG_SNAPSHOT_VERSION = 1; 
+    inline constexpr const char* CONFIG_SNAPSHOT_EXTENSION = ".snapshot"; // written next to the config file
     extern void makeRectsAndBitmasks(); 
+    extern void buildTextureAtlas(); 
 
     // Game display settings
     inline float WORLD_SCALE;
     inline unsigned short WORLD_WIDTH;
     inline unsigned short WORLD_HEIGHT;
     inline unsigned short FRAME_LIMIT;
+    inline unsigned short FIXED_TIMESTEP_RATE;
+    inline float FIXED_TIMESTEP; // 1 / FIXED_TIMESTEP_RATE seconds
+    inline unsigned short MAX_CATCH_UP_STEPS;
     inline std::string GAME_TITLE;
     inline sf::Vector2f VIEW_INITIAL_CENTER;
     inline float VIEW_SIZE_X;
@@ -164,11 +206,33 @@ namespace Constants { // not actually "constants" in terms of being fixed, but s
     inline std::vector<sf::IntRect> TILES_SINGLE_RECTS;
     inline std::vector<std::shared_ptr<sf::Uint8[]>> TILES_BITMASKS;
 
+    // Bitmask cache settings
+    inline std::filesystem::path BITMASK_CACHE_PATH; // empty turns the cache off
+
+    // Texture atlas settings
+    inline bool ATLAS_ENABLED; 
+    inline unsigned int ATLAS_WIDTH; // pixels, widened to fit the widest texture
+    inline unsigned int ATLAS_PADDING; // pixels left empty between packed textures
+    inline std::shared_ptr<sf::Texture> ATLAS_TEXTURE = std::make_shared<sf::Texture>();
+
     // Tilemap settings
     inline size_t TILEMAP_WIDTH;
     inline size_t TILEMAP_HEIGHT;
     inline float TILEMAP_BOUNDARYOFFSET; 
     inline std::filesystem::path TILEMAP_FILEPATH;
+    inline size_t TILEMAP_STREAMING_BUDGET; // bytes, 0 loads the whole map
+
+    // level generator settings
+    inline std::uint64_t LEVELGEN_SEED; 
+    inline bool LEVELGEN_NOISE; // false for uniform random ids
+    inline unsigned int LEVELGEN_THREADS; 
+    inline float LEVELGEN_NOISE_SCALE; 
+    inline unsigned int LEVELGEN_OCTAVES; 
+    inline float LEVELGEN_SURFACE_HEIGHT; 
+    inline float LEVELGEN_AMPLITUDE; 
+    inline std::uint16_t LEVELGEN_AIR_TILE; 
+    inline std::uint16_t LEVELGEN_SURFACE_TILE; 
+    inline std::uint16_t LEVELGEN_GROUND_TILE; 
 
     // Text settings
     inline unsigned short TEXT_SIZE;
@@ -188,6 +252,11 @@ namespace Constants { // not actually "constants" in terms of being fixed, but s
     inline sf::Vector2f ENDINGTEXT_POSITION;
     inline sf::Color ENDINGTEXT_COLOR;
 
+    inline unsigned short HUDTEXT_SIZE;
+    inline sf::Vector2f HUDTEXT_POSITION; // from the view's top left corner
+    inline sf::Color HUDTEXT_COLOR;
+    inline float HUD_REFRESH_TIME; // seconds between performance HUD text updates
+
     // Music settings
     inline std::filesystem::path BACKGROUNDMUSIC_PATH;
     inline float BACKGROUNDMUSIC_VOLUME;
@@ -225,11 +294,14 @@ namespace FlagSystem {
         bool spacePressed; 
         bool mouseClicked;
 
-        FlagEvents() : wPressed(false), aPressed(false), sPressed(false), dPressed(false), bPressed(false), spacePressed(false), mouseClicked(false) {}
+        // toggled, not held
+        bool hudVisible; // performance HUD, F3
+
+        FlagEvents() : wPressed(false), aPressed(false), sPressed(false), dPressed(false), bPressed(false), spacePressed(false), mouseClicked(false), hudVisible(false) {}
 
         // resets every flag
         void resetFlags() {
-            gameEnd = wPressed = aPressed = sPressed = dPressed = bPressed = spacePressed = mouseClicked = false;
+            gameEnd = wPressed = aPressed = sPressed = dPressed = bPressed = spacePressed = mouseClicked = hudVisible = false;
             log_info("General game flags reset complete");
         }
 
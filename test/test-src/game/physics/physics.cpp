@@ -1,52 +1,127 @@
 #include "physics.hpp"
 
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 // physics namespace to have sprites move 
 namespace physics {
     Quadtree::Quadtree(float x, float y, float width, float height, size_t level, size_t maxObjects, size_t maxLevels)
-        : maxObjects(maxObjects), maxLevels(maxLevels), level(level), bounds(x, y, width, height) {}
+        : maxObjects(maxObjects), maxLevels(maxLevels), level(level), bounds(x, y, width, height),
+          looseBounds(x - width * (looseFactor - 1.0f) / 2.0f, y - height * (looseFactor - 1.0f) / 2.0f, width * looseFactor, height * looseFactor) {}
 
     void Quadtree::clear() {
         objects.clear();
-        log_info("objects cleared.");
+        LOG_INFO(Physics, "objects cleared.");
         nodes.clear();
-        log_info("Quadtree cleared.");
+        handles.clear();
+        LOG_INFO(Physics, "Quadtree cleared.");
     }
 
-    std::vector<Sprite*> Quadtree::query(const sf::FloatRect& area) const {
+    bool Quadtree::looseContains(const sf::FloatRect& outer, const sf::FloatRect& inner) {
+        return inner.left >= outer.left && inner.top >= outer.top &&
+               inner.left + inner.width <= outer.left + outer.width &&
+               inner.top + inner.height <= outer.top + outer.height;
+    }
+
+    // picks the child holding the object's center, or nullptr if the object doesn't fit in that child's loose bounds
+    Quadtree* Quadtree::childFor(const sf::FloatRect& objBounds) const {
+        if (nodes.empty()) return nullptr;
+
+        float centerX = objBounds.left + objBounds.width / 2.0f;
+        float centerY = objBounds.top + objBounds.height / 2.0f;
+        size_t index = (centerX >= bounds.left + bounds.width / 2.0f ? 1 : 0) + (centerY >= bounds.top + bounds.height / 2.0f ? 2 : 0);
+
+        Quadtree* child = nodes[index].get();
+        return looseContains(child->looseBounds, objBounds) ? child : nullptr;
+    }
+
+    // walks down from this node, stores the object in the deepest fitting node and splits that node if it got too full
+    Quadtree* Quadtree::place(Sprite* obj, const sf::FloatRect& objBounds) {
+        Quadtree* node = this;
+        while (Quadtree* child = node->childFor(objBounds)) {
+            node = child;
+        }
+        node->objects.push_back(obj);
+        root->handles[obj] = node;
+
+        if (node->nodes.empty() && node->objects.size() > maxObjects && node->level < maxLevels) {
+            node->subdivide();
+        }
+        return node;
+    }
+
+    void Quadtree::insert(Sprite* obj) {
         try {
-            std::vector<Sprite*> result;
-            if (!bounds.intersects(area)) {
-                log_warning("Area does not intersect with the quadtree bounds at level " + std::to_string(level));
-                return result;
+            if (!obj) return;
+            if (root != this) {
+                root->insert(obj);
+                return;
             }
-
-            for (const auto& obj : objects) {
-                if (area.intersects(obj->returnSpritesShape().getGlobalBounds())) {
-                    result.push_back(obj);
-                    log_info("Sprite added to query result at level " + std::to_string(level));
-                }
+            if (handles.count(obj)) { // already in the tree, just make sure it sits in the right node
+                relocate(obj);
+                return;
             }
+            Quadtree* node = place(obj, obj->returnSpritesShape().getGlobalBounds());
+            LOG_INFO(Physics, "Sprite inserted into quadtree node at level {}", node->level);
+        } catch (const std::exception& e) {
+            LOG_ERROR(Physics, "Error during insert: {}", e.what());
+        }
+    }
 
-            for (const auto& node : nodes) {
-                auto nodeResult = node->query(area);
-                result.insert(result.end(), nodeResult.begin(), nodeResult.end());
+    void Quadtree::remove(Sprite* obj) {
+        try {
+            if (root != this) {
+                root->remove(obj);
+                return;
             }
+            auto handle = handles.find(obj);
+            if (handle == handles.end()) return;
+
+            Quadtree* node = handle->second;
+            node->objects.erase(std::remove(node->objects.begin(), node->objects.end(), obj), node->objects.end());
+            handles.erase(handle);
+            LOG_INFO(Physics, "Sprite removed from quadtree at level {}", node->level);
+            merge(node); // may free node
+        } catch (const std::exception& e) {
+            LOG_ERROR(Physics, "Error during remove: {}", e.what());
+        }
+    }
+
+    std::vector<Sprite*> Quadtree::query(const sf::FloatRect& area) const {
+        try {
+            std::vector<Sprite*> result;
+            queryInto(area, result);
             return result;
 
         } catch (const std::exception& e) {
-            log_error("Error during query at level " + std::to_string(level) + ": " + std::string(e.what()));
+            LOG_ERROR(Physics, "Error during query at level {}: {}", level, e.what());
             return std::vector<Sprite*>();
         }
     }
 
+    void Quadtree::queryInto(const sf::FloatRect& area, std::vector<Sprite*>& result) const {
+        // the root also keeps sprites that are outside of the world, so only child nodes get pruned 
+        if (parent && !looseBounds.intersects(area)) return;
+
+        for (const auto& obj : objects) {
+            if (area.intersects(obj->returnSpritesShape().getGlobalBounds())) {
+                result.push_back(obj);
+            }
+        }
+        for (const auto& node : nodes) {
+            node->queryInto(area, result);
+        }
+    }
+
     bool Quadtree::contains(const sf::FloatRect& bounds) const {
         try {
             bool result = this->bounds.contains(bounds.left, bounds.top) && this->bounds.contains(bounds.left + bounds.width, bounds.top + bounds.height);
-            log_info(result ? "Bounds are contained in the quadtree at level " + std::to_string(level) :
-                            "Bounds are not contained in the quadtree at level " + std::to_string(level));
+            if (result) LOG_INFO(Physics, "Bounds are contained in the quadtree at level {}", level);
+            else LOG_INFO(Physics, "Bounds are not contained in the quadtree at level {}", level);
             return result;
         } catch (const std::exception& e) {
-            log_error("Error during contains check at level " + std::to_string(level) + ": " + std::string(e.what()));
+            LOG_ERROR(Physics, "Error during contains check at level {}: {}", level, e.what());
             return false;
         }
     }
@@ -55,68 +130,135 @@ namespace physics {
         try {
             // Check if we've reached the max level
             if (level >= maxLevels) {
-                log_info("Maximum level reached, cannot subdivide further.");
+                LOG_INFO(Physics, "Maximum level reached, cannot subdivide further.");
                 return;
             }
+            if (!nodes.empty()) return; 
 
             float halfWidth = bounds.width / 2;
             float halfHeight = bounds.height / 2;
             float x = bounds.left;
             float y = bounds.top;
 
-            // Create four child nodes with smaller bounds and increment the level
+            // Create four child nodes with smaller bounds and increment the level (order matters for childFor)
             nodes.push_back(std::make_unique<Quadtree>(x, y, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
             nodes.push_back(std::make_unique<Quadtree>(x + halfWidth, y, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
             nodes.push_back(std::make_unique<Quadtree>(x, y + halfHeight, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
             nodes.push_back(std::make_unique<Quadtree>(x + halfWidth, y + halfHeight, halfWidth, halfHeight, level + 1, maxObjects, maxLevels));
+            for (auto& node : nodes) {
+                node->parent = this;
+                node->root = root;
+            }
 
-            log_info("Quadtree subdivided into 4 child nodes at level " + std::to_string(level));
-
-            // Redistribute the objects into the appropriate child nodes
-            for (auto it = objects.begin(); it != objects.end(); ) {
-                bool inserted = false;
-                for (auto& node : nodes) {
-                    if (node->bounds.intersects((*it)->returnSpritesShape().getGlobalBounds())) {
-                        node->objects.push_back(*it);
-                        it = objects.erase(it); // Remove object from the current node
-                        inserted = true;
-                        log_info("Sprite moved to child node at level " + std::to_string(node->level));
-                        break;
-                    }
-                }
-                if (!inserted) {
-                    ++it;
+            LOG_INFO(Physics, "Quadtree subdivided into 4 child nodes at level {}", level);
+
+            // Push every object that fits into a child's loose bounds down, the rest stays here
+            std::vector<Sprite*> remaining;
+            for (Sprite* obj : objects) {
+                if (Quadtree* child = childFor(obj->returnSpritesShape().getGlobalBounds())) {
+                    child->objects.push_back(obj);
+                    root->handles[obj] = child;
+                } else {
+                    remaining.push_back(obj);
                 }
             }
+            objects = std::move(remaining);
+
+            for (auto& node : nodes) {
+                if (node->objects.size() > maxObjects) node->subdivide();
+            }
         } catch (const std::exception& e) {
-            log_error("Error during subdivision at level " + std::to_string(level) + ": " + std::string(e.what()));
+            LOG_ERROR(Physics, "Error during subdivision at level {}: {}", level, e.what());
+        }
+    }
+
+    // counts the objects of the subtree, giving up as soon as there are more than limit
+    size_t Quadtree::countObjects(size_t limit) const {
+        size_t count = objects.size();
+        for (const auto& node : nodes) {
+            if (count > limit) break;
+            count += node->countObjects(limit - count);
+        }
+        return count;
+    }
+
+    size_t Quadtree::getNodeCount() const {
+        size_t count = 1;
+        for (const auto& node : nodes) {
+            count += node->getNodeCount();
+        }
+        return count;
+    }
+
+    size_t Quadtree::getDepth() const {
+        size_t depth = 0;
+        for (const auto& node : nodes) {
+            depth = std::max(depth, node->getDepth() + 1);
+        }
+        return depth;
+    }
+
+    // pulls every object of the subtree back into this node and drops the children
+    void Quadtree::collapse() {
+        for (auto& node : nodes) {
+            node->collapse();
+            for (Sprite* obj : node->objects) {
+                objects.push_back(obj);
+                root->handles[obj] = this;
+            }
+        }
+        nodes.clear();
+    }
+
+    // collapses start's ancestors until one still holds more than maxObjects in total.
+    // static since collapsing an ancestor frees start, so nothing may be read through it afterwards
+    void Quadtree::merge(Quadtree* start) {
+        Quadtree* node = start->nodes.empty() ? start->parent : start;
+        while (node && node->countObjects(node->maxObjects) <= node->maxObjects) {
+            node->collapse();
+            LOG_INFO(Physics, "Quadtree merged at level {}", node->level);
+            node = node->parent;
+        }
+    }
+
+    void Quadtree::relocate(Sprite* obj) {
+        auto handle = handles.find(obj);
+        if (handle == handles.end()) return;
+
+        Quadtree* oldNode = handle->second;
+        oldNode->objects.erase(std::remove(oldNode->objects.begin(), oldNode->objects.end(), obj), oldNode->objects.end());
+
+        // climb to the closest ancestor that still holds the sprite, then sink it as deep as it fits
+        sf::FloatRect objBounds = obj->returnSpritesShape().getGlobalBounds();
+        Quadtree* start = oldNode;
+        while (start->parent && !looseContains(start->looseBounds, objBounds)) {
+            start = start->parent;
         }
+        Quadtree* newNode = start->place(obj, objBounds);
+
+        if (newNode != oldNode) merge(oldNode);
     }
 
     void Quadtree::update() {
         try {
-            for (auto& sprite : objects) {
-              //  log_info("Updating quadtree at level " + std::to_string(level));
-
-                if (sprite->getMoveState()) {
-                    // Check which node the sprite was in
-                    for (auto& node : nodes) {
-                        if (node->contains(sprite->returnSpritesShape().getGlobalBounds())) {
-                            // Remove sprite from the old node
-                            node->objects.erase(std::remove(node->objects.begin(), node->objects.end(), sprite), node->objects.end());
-                            log_info("Sprite removed from old node at level " + std::to_string(node->level));
-                            break;
-                        }
-                    }
-
-                    // Insert the sprite back into the quadtree
-                    std::unique_ptr<Sprite> spritePtr(sprite);
-                    insert(spritePtr);
-                    log_info("Sprite updated and inserted into quadtree at level " + std::to_string(level));
-                }
+            if (root != this) {
+                root->update();
+                return;
+            }
+
+            std::vector<Sprite*> moved;
+            for (const auto& [obj, node] : handles) {
+                sf::FloatRect objBounds = obj->returnSpritesShape().getGlobalBounds();
+                bool leftNode = node->parent && !looseContains(node->looseBounds, objBounds);
+                bool fitsDeeper = node->childFor(objBounds) != nullptr;
+                if (leftNode || fitsDeeper) moved.push_back(obj);
+            }
+
+            for (Sprite* obj : moved) {
+                relocate(obj);
             }
         } catch (const std::exception& e) {
-            log_error("Error during update at level " + std::to_string(level) + ": " + std::string(e.what()));
+            LOG_ERROR(Physics, "Error during update at level {}: {}", level, e.what());
         }
     }
 
@@ -148,6 +290,57 @@ namespace physics {
         return { originalPos.x, originalPos.y += speed * MetaComponents::deltaTime * acceleration.y};
     }
 
+    // position[i] += speed[i] * scale (* acceleration[i]) (* direction[i]), 8 or 4 lanes at a time when available
+    template<bool hasAcceleration, bool hasDirection>
+    static void integrateAxis(float* position, const float* speed, const float* acceleration, const float* direction, float scale, size_t count) {
+        size_t i = 0;
+    #if defined(__AVX__)
+        const __m256 scale8 = _mm256_set1_ps(scale);
+        for (; i + 8 <= count; i += 8) {
+            __m256 step = _mm256_mul_ps(_mm256_loadu_ps(speed + i), scale8);
+            if constexpr (hasAcceleration) step = _mm256_mul_ps(step, _mm256_loadu_ps(acceleration + i));
+            if constexpr (hasDirection) step = _mm256_mul_ps(step, _mm256_loadu_ps(direction + i));
+            _mm256_storeu_ps(position + i, _mm256_add_ps(_mm256_loadu_ps(position + i), step));
+        }
+    #endif
+    #if defined(__SSE2__)
+        const __m128 scale4 = _mm_set1_ps(scale);
+        for (; i + 4 <= count; i += 4) {
+            __m128 step = _mm_mul_ps(_mm_loadu_ps(speed + i), scale4);
+            if constexpr (hasAcceleration) step = _mm_mul_ps(step, _mm_loadu_ps(acceleration + i));
+            if constexpr (hasDirection) step = _mm_mul_ps(step, _mm_loadu_ps(direction + i));
+            _mm_storeu_ps(position + i, _mm_add_ps(_mm_loadu_ps(position + i), step));
+        }
+    #endif
+        for (; i < count; ++i) {
+            float step = speed[i] * scale;
+            if constexpr (hasAcceleration) step *= acceleration[i];
+            if constexpr (hasDirection) step *= direction[i];
+            position[i] += step;
+        }
+    }
+
+    void freeFallBulk(float* positionY, const float* speed, size_t count){
+        integrateAxis<false, false>(positionY, speed, nullptr, nullptr, MetaComponents::deltaTime, count);
+    }
+    void followBulk(float* positionX, float* positionY, const float* directionX, const float* directionY, 
+                    const float* speed, const float* accelerationX, const float* accelerationY, size_t count){
+        integrateAxis<true, true>(positionX, speed, accelerationX, directionX, MetaComponents::deltaTime, count);
+        integrateAxis<true, true>(positionY, speed, accelerationY, directionY, MetaComponents::deltaTime, count);
+    }
+    void moveLeftBulk(float* positionX, const float* speed, const float* accelerationX, size_t count){
+        integrateAxis<true, false>(positionX, speed, accelerationX, nullptr, -MetaComponents::deltaTime, count);
+    }
+    void moveRightBulk(float* positionX, const float* speed, const float* accelerationX, size_t count){
+        integrateAxis<true, false>(positionX, speed, accelerationX, nullptr, MetaComponents::deltaTime, count);
+    }
+    void moveUpBulk(float* positionY, const float* speed, const float* accelerationY, size_t count){
+        integrateAxis<true, false>(positionY, speed, accelerationY, nullptr, -MetaComponents::deltaTime, count);
+    }
+    void moveDownBulk(float* positionY, const float* speed, const float* accelerationY, size_t count){
+        integrateAxis<true, false>(positionY, speed, accelerationY, nullptr, MetaComponents::deltaTime, count);
+    }
+
     sf::Vector2f jump(float& elapsedTime, float speed, sf::Vector2f originalPos, sf::Vector2f acceleration){
         float jumpDuration = 0.8f; 
         if (elapsedTime <= jumpDuration) {   // If elapsedTime is within jump duration
@@ -297,43 +490,135 @@ namespace physics {
         return !(xOverlapStart >= xOverlapEnd || yOverlapStart >= yOverlapEnd); 
     }
 
-    bool pixelPerfectCollision( const std::shared_ptr<sf::Uint8[]>& bitmask1, const sf::Vector2f& position1, const sf::Vector2f& size1,
-                                const std::shared_ptr<sf::Uint8[]>& bitmask2, const sf::Vector2f& position2, const sf::Vector2f& size2) {
+    // read-only view of a packed bitmask and its coarse levels, placed at whole pixels in world space. width and height are the 
+    // mask's own, worldWidth and worldHeight the size it covers in the world (they differ when the sprite is scaled)
+    struct BitmaskView {
+        const sf::Uint8* data;
+        int x;
+        int y;
+        unsigned int width;
+        unsigned int height;
+        unsigned int worldWidth;
+        unsigned int worldHeight;
+
+        bool scaled() const { return width != worldWidth || height != worldHeight; }
+        // the full resolution bit under a world pixel, for scaled masks
+        bool pixelAt(int worldX, int worldY) const {
+            unsigned int maskX = std::min(width - 1, static_cast<unsigned int>((worldX - x + 0.5f) * width / worldWidth));
+            unsigned int maskY = std::min(height - 1, static_cast<unsigned int>((worldY - y + 0.5f) * height / worldHeight));
+            return occupied(0, maskX, maskY);
+        }
 
-        // Helper function to get the pixel index in the bitmask
-        auto getPixelIndex = [](const sf::Vector2f& size, int x, int y) -> int {
-            return (y * static_cast<int>(size.x) + x) * 4; // Each pixel has 4 bytes (RGBA)
+        const sf::Uint8* levelRow(unsigned int level, unsigned int row) const {
+            return data + Constants::bitmaskLevelOffset(width, height, level) + static_cast<size_t>(row) * Constants::bitmaskRowBytes(Constants::bitmaskLevelSize(width, level));
+        }
+        bool occupied(unsigned int level, unsigned int blockX, unsigned int blockY) const {
+            return levelRow(level, blockY)[blockX / 8] & (1 << (blockX % 8));
+        }
+        // checks every block of this level touching the world rect [left, right) x [top, bottom)
+        bool anyOccupied(unsigned int level, int left, int top, int right, int bottom) const {
+            unsigned int blockSize = Constants::BITMASK_LEVEL_BLOCKS[level];
+            for (unsigned int blockY = (top - y) / blockSize; blockY <= (bottom - 1 - y) / blockSize; ++blockY) {
+                for (unsigned int blockX = (left - x) / blockSize; blockX <= (right - 1 - x) / blockSize; ++blockX) {
+                    if (occupied(level, blockX, blockY)) return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    // exact test of a world rect inside both masks, 64 pixels per AND
+    static bool pixelsOverlap(const BitmaskView& a, const BitmaskView& b, int left, int top, int right, int bottom) {
+        // Helper to read one 64-bit word of a row (bitmasks are stored low bit first)
+        auto loadWord = [](const sf::Uint8* row, unsigned int word) -> std::uint64_t {
+            std::uint64_t value;
+            std::memcpy(&value, row + word * 8, sizeof(value));
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            value = __builtin_bswap64(value);
+        #endif
+            return value;
+        };
+
+        // Helper to get 64 pixels of a row starting at any bit, pulling in the next word if the span straddles two
+        auto extractBits = [&loadWord](const sf::Uint8* row, unsigned int rowWords, unsigned int bit) -> std::uint64_t {
+            unsigned int word = bit / 64;
+            unsigned int shift = bit % 64;
+            std::uint64_t value = loadWord(row, word) >> shift;
+            if (shift && word + 1 < rowWords) value |= loadWord(row, word + 1) << (64 - shift);
+            return value;
         };
 
+        const unsigned int rowWordsA = Constants::bitmaskRowWords(a.width);
+        const unsigned int rowWordsB = Constants::bitmaskRowWords(b.width);
+        const unsigned int offsetA = static_cast<unsigned int>(left - a.x);
+        const unsigned int offsetB = static_cast<unsigned int>(left - b.x);
+        const unsigned int span = static_cast<unsigned int>(right - left);
+
+        for (int y = top; y < bottom; ++y) {
+            const sf::Uint8* rowA = a.levelRow(0, y - a.y);
+            const sf::Uint8* rowB = b.levelRow(0, y - b.y);
+
+            for (unsigned int bit = 0; bit < span; bit += 64) {
+                std::uint64_t overlap = extractBits(rowA, rowWordsA, offsetA + bit) & extractBits(rowB, rowWordsB, offsetB + bit);
+                if (span - bit < 64) overlap &= (std::uint64_t(1) << (span - bit)) - 1; // drop pixels past the overlap
+
+                if (overlap) return true; // Collision detected
+            }
+        }
+        return false;
+    }
+
+    // walks the occupied blocks of a at this level and only descends where b also has something underneath
+    static bool blocksOverlap(const BitmaskView& a, const BitmaskView& b, unsigned int level, int left, int top, int right, int bottom) {
+        if (level == 0) return pixelsOverlap(a, b, left, top, right, bottom);
+
+        const int blockSize = static_cast<int>(Constants::BITMASK_LEVEL_BLOCKS[level]);
+        for (int blockY = (top - a.y) / blockSize; blockY <= (bottom - 1 - a.y) / blockSize; ++blockY) {
+            for (int blockX = (left - a.x) / blockSize; blockX <= (right - 1 - a.x) / blockSize; ++blockX) {
+                if (!a.occupied(level, blockX, blockY)) continue;
+
+                int blockLeft = std::max(left, a.x + blockX * blockSize);
+                int blockTop = std::max(top, a.y + blockY * blockSize);
+                int blockRight = std::min(right, a.x + (blockX + 1) * blockSize);
+                int blockBottom = std::min(bottom, a.y + (blockY + 1) * blockSize);
+
+                if (!b.anyOccupied(level, blockLeft, blockTop, blockRight, blockBottom)) continue;
+                if (blocksOverlap(a, b, level - 1, blockLeft, blockTop, blockRight, blockBottom)) return true;
+            }
+        }
+        return false;
+    }
+
+    bool pixelPerfectCollision( const std::shared_ptr<sf::Uint8[]>& bitmask1, const sf::Vector2f& position1, const sf::Vector2f& size1, const sf::Vector2u& maskSize1,
+                                const std::shared_ptr<sf::Uint8[]>& bitmask2, const sf::Vector2f& position2, const sf::Vector2f& size2, const sf::Vector2u& maskSize2) {
+        if (!bitmask1 || !bitmask2 || !maskSize1.x || !maskSize1.y || !maskSize2.x || !maskSize2.y) return false;
+
+        // Snap both masks to whole pixels in world space
+        BitmaskView mask1 { bitmask1.get(), static_cast<int>(std::floor(position1.x)), static_cast<int>(std::floor(position1.y)),
+                            maskSize1.x, maskSize1.y, static_cast<unsigned int>(size1.x), static_cast<unsigned int>(size1.y) };
+        BitmaskView mask2 { bitmask2.get(), static_cast<int>(std::floor(position2.x)), static_cast<int>(std::floor(position2.y)),
+                            maskSize2.x, maskSize2.y, static_cast<unsigned int>(size2.x), static_cast<unsigned int>(size2.y) };
+
         // Calculate the overlapping area between the two objects
-        float left = std::max(position1.x, position2.x);
-        float top = std::max(position1.y, position2.y);
-        float right = std::min(position1.x + size1.x, position2.x + size2.x);
-        float bottom = std::min(position1.y + size1.y, position2.y + size2.y);
+        int left = std::max(mask1.x, mask2.x);
+        int top = std::max(mask1.y, mask2.y);
+        int right = std::min(mask1.x + static_cast<int>(mask1.worldWidth), mask2.x + static_cast<int>(mask2.worldWidth));
+        int bottom = std::min(mask1.y + static_cast<int>(mask1.worldHeight), mask2.y + static_cast<int>(mask2.worldHeight));
 
         // Check AABB collision first
         if (left >= right || top >= bottom) return false; 
-        //std::cout << "AABB collision passed." << std::endl;
-        // Check each pixel in the overlapping area
-        for (int y = static_cast<int>(top); y < static_cast<int>(bottom); ++y) {
-            for (int x = static_cast<int>(left); x < static_cast<int>(right); ++x) {
-                // Calculate the position in each bitmask
-                int x1 = x - static_cast<int>(position1.x);
-                int y1 = y - static_cast<int>(position1.y);
-                int x2 = x - static_cast<int>(position2.x);
-                int y2 = y - static_cast<int>(position2.y);
-
-                // Get the index of the pixel in each bitmask
-                int index1 = getPixelIndex(size1, x1, y1);
-                int index2 = getPixelIndex(size2, x2, y2);
-
-                // Check if the pixels' values are non-zero (i.e., not transparent)
-                if (bitmask1[index1] == 1 && bitmask2[index2] == 1) {
-                    return true; // Collision detected
+
+        // the block levels and 64 bit rows assume one mask pixel per world pixel; scaled masks are sampled pixel by pixel instead
+        if (mask1.scaled() || mask2.scaled()) {
+            for (int y = top; y < bottom; ++y) {
+                for (int x = left; x < right; ++x) {
+                    if (mask1.pixelAt(x, y) && mask2.pixelAt(x, y)) return true;
                 }
             }
+            return false;
         }
-        //std::cout << "Pixel perfect collision passed." << std::endl;
-        return false; 
+
+        // Coarse to fine, starting from the largest blocks 
+        return blocksOverlap(mask1, mask2, Constants::BITMASK_LEVELS - 1, left, top, right, bottom);
     }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <type_traits>
 #include <iostream>
+#include <cstdlib>
 #include <memory>
 #include <vector>
 #include <stdexcept>
@@ -9,6 +10,10 @@
 #include <math.h>
 #include <functional> 
 #include <utility>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 #include "../../test-assets/sprites/sprites.hpp" 
 #include "../../test-assets/tiles/tiles.hpp" 
@@ -16,44 +21,51 @@
 
 namespace physics{
 
+    // loose quadtree; sprites live in the deepest node whose loose bounds fully contain them 
     class Quadtree {
     public:
         Quadtree(float x, float y, float width, float height, size_t level = 0, size_t maxObjects = 10, size_t maxLevels = 5);
         ~Quadtree(){ clear(); };
+        Quadtree(const Quadtree&) = delete;
+        Quadtree& operator=(const Quadtree&) = delete;
 
         void clear();
 
         template<typename SpriteType> void insert(std::unique_ptr<SpriteType>& obj) { 
-            try {
-                // If no child nodes exist, add the object to this node
-                if (nodes.empty()) {
-                    objects.push_back(obj.get());
-                    log_info("Sprite inserted into quadtree node.");
-                } else {
-                    // Check which child node the object belongs to
-                    for (auto& node : nodes) {
-                        if (node->bounds.contains(obj->returnSpritesShape().getPosition())) {
-                            node->insert(obj);
-                            log_info("Sprite inserted into child node.");
-                            return;
-                        }
-                    }
-                }
-            } catch (const std::exception& e) {
-                log_error("Error during insert: " + std::string(e.what()));
-            }
+            if (obj) insert(static_cast<Sprite*>(obj.get()));
         }
+        void insert(Sprite* obj);
+        void remove(Sprite* obj);
 
         std::vector<Sprite*> query(const sf::FloatRect& area) const;
         void subdivide();
         bool contains(const sf::FloatRect& bounds) const;
-        void update(); 
+        void update(); // relocates only the sprites that left their node's loose bounds
+
+        size_t getNodeCount() const; // this node and every node under it
+        size_t getDepth() const; // levels below this node, 0 when it isn't subdivided
 
     private:
+        static constexpr float looseFactor = 2.0f; // loose bounds are this many times the size of the node bounds
+
+        static bool looseContains(const sf::FloatRect& outer, const sf::FloatRect& inner);
+        Quadtree* childFor(const sf::FloatRect& objBounds) const;
+        Quadtree* place(Sprite* obj, const sf::FloatRect& objBounds);
+        void relocate(Sprite* obj);
+        static void merge(Quadtree* start);
+        void collapse();
+        size_t countObjects(size_t limit) const;
+        void queryInto(const sf::FloatRect& area, std::vector<Sprite*>& result) const;
+
         size_t maxObjects;
         size_t maxLevels;
         size_t level;
         sf::FloatRect bounds;
+        sf::FloatRect looseBounds;
+
+        Quadtree* parent = nullptr;
+        Quadtree* root = this;
+        std::unordered_map<Sprite*, Quadtree*> handles; // only filled in the root; sprite -> node holding it
 
         std::vector<Sprite*> objects;
         std::vector<std::unique_ptr<Quadtree>> nodes;
@@ -79,6 +91,15 @@ namespace physics{
     sf::Vector2f jump(float& elapsedTime, float speed, sf::Vector2f originalPos, sf::Vector2f acceleration = {0.1f, 0.1f}); 
     sf::Vector2f jumpToSurface(float& elapsedTime, float speed, sf::Vector2f originalPos, sf::Vector2f acceleration = {0.1f, 0.1f}); 
 
+    // bulk movement over spans of packed floats; uses AVX or SSE2 when the compiler targets them, scalar otherwise
+    void freeFallBulk(float* positionY, const float* speed, size_t count); 
+    void followBulk(float* positionX, float* positionY, const float* directionX, const float* directionY, 
+                    const float* speed, const float* accelerationX, const float* accelerationY, size_t count); 
+    void moveLeftBulk(float* positionX, const float* speed, const float* accelerationX, size_t count); 
+    void moveRightBulk(float* positionX, const float* speed, const float* accelerationX, size_t count); 
+    void moveUpBulk(float* positionY, const float* speed, const float* accelerationY, size_t count); 
+    void moveDownBulk(float* positionY, const float* speed, const float* accelerationY, size_t count); 
+
     template<typename SpriteType, typename MoveFunc>
     void spriteMover(std::unique_ptr<SpriteType>& sprite, const MoveFunc& moveFunc) {
         float speed = sprite->getSpeed(); 
@@ -116,9 +137,15 @@ namespace physics{
                             const sf::Vector2f obj2position, const sf::Vector2f obj2direction, float obj2Speed, const sf::FloatRect obj2Bounds, sf::Vector2f obj2Acceleration);
     //axis aligned bounding box collision
     bool boundingBoxCollision(const sf::Vector2f &position1, const sf::Vector2f& size1, const sf::Vector2f &position2, const sf::Vector2f& size2);
-    //pixel perfect collision
-    bool pixelPerfectCollision( const std::shared_ptr<sf::Uint8[]> &bitmask1, const sf::Vector2f &position1, const sf::Vector2f &size1,
-                                const std::shared_ptr<sf::Uint8[]> &bitmask2, const sf::Vector2f &position2, const sf::Vector2f &size2);  
+    //pixel perfect collision; size is the world size the mask is drawn at, maskSize the texture rect it was made from
+    bool pixelPerfectCollision( const std::shared_ptr<sf::Uint8[]> &bitmask1, const sf::Vector2f &position1, const sf::Vector2f &size1, const sf::Vector2u &maskSize1,
+                                const std::shared_ptr<sf::Uint8[]> &bitmask2, const sf::Vector2f &position2, const sf::Vector2f &size2, const sf::Vector2u &maskSize2);  
+
+    // dimensions of the bitmask behind a sprite, which are those of its texture rect (flipped rects have negative sizes)
+    inline sf::Vector2u bitmaskSize(const sf::Sprite& sprite) {
+        sf::IntRect rect = sprite.getTextureRect();
+        return { static_cast<unsigned int>(std::abs(rect.width)), static_cast<unsigned int>(std::abs(rect.height)) };
+    }
     
     struct CollisionData {
         sf::Vector2f position;
@@ -128,6 +155,7 @@ namespace physics{
         sf::Vector2f acceleration;
         sf::Vector2f size;
         std::shared_ptr<sf::Uint8[]> bitmask; // for bitmask-based collision
+        sf::Vector2u maskSize; // the bitmask's own width and height (its texture rect), not the same as size when the sprite is scaled
         sf::FloatRect bounds;
     };
 
@@ -150,9 +178,141 @@ namespace physics{
         }
 
         data.bitmask = sprite->getBitmask(sprite->getCurrIndex());
+        data.maskSize = bitmaskSize(sprite->returnSpritesShape());
         return data;
     }
 
+    // collision tests run by collisionHelper and collisionHelperBatch since the count was last reset; the performance HUD 
+    // reads and resets it every frame. game loop thread only
+    inline size_t collisionTestCount = 0; 
+
+    // candidate data for collisionHelperBatch, kept as structure of arrays so the broad phase loops vectorize
+    struct CollisionBatch {
+        std::vector<float> left;
+        std::vector<float> top;
+        std::vector<float> width;
+        std::vector<float> height;
+        std::vector<float> radius;
+        std::vector<std::uint8_t> hit;
+
+        void resize(size_t count) {
+            left.resize(count);
+            top.resize(count);
+            width.resize(count);
+            height.resize(count);
+            radius.resize(count);
+            hit.resize(count);
+        }
+    };
+
+    // tests one probe against a whole sprite collection and returns every candidate it touches. 
+    // the probe's data is extracted once, and bitmasks are only fetched for candidates that pass the box test
+    template<typename ProbeType, typename SpriteType, typename CollisionFunc>
+    std::vector<SpriteType*> collisionHelperBatch(const ProbeType& probe, const std::vector<std::unique_ptr<SpriteType>>& candidates, CollisionFunc&& collisionFunc) {
+        constexpr bool isCircle = std::is_invocable_v<CollisionFunc, sf::Vector2f, float, sf::Vector2f, float>;
+        constexpr bool isBox = std::is_invocable_v<CollisionFunc, sf::Vector2f, sf::Vector2f, sf::Vector2f, sf::Vector2f>;
+        constexpr bool isBitmask = std::is_invocable_v<CollisionFunc, std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f, sf::Vector2u,
+                                                                      std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f, sf::Vector2u>;
+        static_assert(isCircle || isBox || isBitmask, "collisionHelperBatch supports circle, bounding box and pixel perfect collision");
+
+        std::vector<SpriteType*> hits;
+        if (!probe || candidates.empty()) return hits;
+
+        const CollisionData probeData = extractCollisionData(probe);
+        const size_t count = candidates.size();
+        collisionTestCount += count; 
+
+        static thread_local CollisionBatch batch; // reused between calls to avoid allocating every frame
+        batch.resize(count);
+
+        // gather candidate positions and sizes the same way extractCollisionData does
+        for (size_t i = 0; i < count; ++i) {
+            const auto& candidate = candidates[i];
+            if (!candidate) {
+                batch.left[i] = batch.top[i] = batch.width[i] = batch.height[i] = batch.radius[i] = 0.0f;
+                continue;
+            }
+            sf::FloatRect bounds = candidate->returnSpritesShape().getGlobalBounds();
+            if (candidate->isAnimated()) {
+                sf::IntRect rect = candidate->getRects();
+                batch.left[i] = bounds.left;
+                batch.top[i] = bounds.top;
+                batch.width[i] = static_cast<float>(rect.width);
+                batch.height[i] = static_cast<float>(rect.height);
+            } else {
+                sf::Vector2f position = candidate->getSpritePos();
+                batch.left[i] = position.x;
+                batch.top[i] = position.y;
+                batch.width[i] = bounds.width;
+                batch.height[i] = bounds.height;
+            }
+            if constexpr (isCircle) batch.radius[i] = candidate->getRadius();
+        }
+
+        const float* left = batch.left.data();
+        const float* top = batch.top.data();
+        const float* width = batch.width.data();
+        const float* height = batch.height.data();
+        const float* radius = batch.radius.data();
+        std::uint8_t* hit = batch.hit.data();
+
+        // broad phase over the packed arrays, no branches or virtual calls
+        if constexpr (isCircle) {
+            for (size_t i = 0; i < count; ++i) {
+                float dx = probeData.position.x - left[i];
+                float dy = probeData.position.y - top[i];
+                float radiusSum = probeData.radius + radius[i];
+                hit[i] = dx * dx + dy * dy <= radiusSum * radiusSum;
+            }
+        } else {
+            const float probeRight = probeData.position.x + probeData.size.x;
+            const float probeBottom = probeData.position.y + probeData.size.y;
+            for (size_t i = 0; i < count; ++i) {
+                hit[i] = (std::max(probeData.position.x, left[i]) < std::min(probeRight, left[i] + width[i])) &
+                         (std::max(probeData.position.y, top[i]) < std::min(probeBottom, top[i] + height[i]));
+            }
+        }
+
+        // narrow phase only for the candidates that passed
+        for (size_t i = 0; i < count; ++i) {
+            if (!hit[i] || !candidates[i]) continue;
+
+            if constexpr (isBitmask && !isCircle && !isBox) {
+                const auto& candidate = candidates[i];
+                if (!collisionFunc(probeData.bitmask, probeData.position, probeData.size, probeData.maskSize,
+                                   candidate->getBitmask(candidate->getCurrIndex()), sf::Vector2f(left[i], top[i]), sf::Vector2f(width[i], height[i]), 
+                                   bitmaskSize(candidate->returnSpritesShape()))) {
+                    continue;
+                }
+            }
+            hits.push_back(candidates[i].get());
+        }
+        return hits;
+    }
+
+    // tiles under the sprite's bounds, looked up in O(cells covered) instead of going through the quadtree. with pixelPerfect 
+    // each tile's bitmask (its texture rect's size) is also tested against the sprite's current bitmask, over the tile's scaled size
+    template<typename SpriteType>
+    std::vector<TileCell> tileCollisions(const SpriteType& sprite, const TileMap& tileMap, TileFilter filter = TileFilter::Solid, bool pixelPerfect = false) {
+        std::vector<TileCell> cells;
+        if (!sprite) return cells;
+
+        CollisionData data = extractCollisionData(sprite);
+        cells = tileMap.queryTiles(data.bounds, filter);
+        if (!pixelPerfect) return cells;
+
+        auto missed = [&data](const TileCell& cell) {
+            sf::IntRect tileRect = cell.tile->getTextureRect();
+            sf::Vector2f tileScale = cell.tile->getScale();
+            sf::Vector2u tileMaskSize(static_cast<unsigned int>(tileRect.width), static_cast<unsigned int>(tileRect.height));
+            sf::Vector2f tileSize(tileRect.width * tileScale.x, tileRect.height * tileScale.y);
+            return !pixelPerfectCollision(data.bitmask, data.position, data.size, data.maskSize, cell.tile->getBitMask().lock(), cell.position,
+                                          tileSize, tileMaskSize);
+        };
+        cells.erase(std::remove_if(cells.begin(), cells.end(), missed), cells.end());
+        return cells;
+    }
+
     template<typename ObjType1, typename ObjType2, typename... Args>
     bool collisionHelper(ObjType1&& obj1, ObjType2&& obj2, Args&&... args) {
         auto getSprite = [](auto&& obj) -> auto& {
@@ -162,6 +322,7 @@ namespace physics{
 
         auto& sprite1 = getSprite(std::forward<ObjType1>(obj1));
         CollisionData data1 = extractCollisionData(sprite1);
+        ++collisionTestCount; 
 
         if constexpr (sizeof...(Args) == 0) {
             // Handle sprite vs. non-sprite (mouse, view, tilemap)
@@ -238,9 +399,9 @@ namespace physics{
                         cachedRaycastResult.counter = 0;
                         return true;
                     }
-                } else if constexpr (std::is_invocable_v<decltype(func), std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f,
-                                                                        std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f>) {
-                    return func(d1.bitmask, d1.position, d1.size, d2.bitmask, d2.position, d2.size);
+                } else if constexpr (std::is_invocable_v<decltype(func), std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f, sf::Vector2u,
+                                                                        std::shared_ptr<sf::Uint8[]>, sf::Vector2f, sf::Vector2f, sf::Vector2u>) {
+                    return func(d1.bitmask, d1.position, d1.size, d1.maskSize, d2.bitmask, d2.position, d2.size, d2.maskSize);
                 }
                 return false;
             };
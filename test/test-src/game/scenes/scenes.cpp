@@ -9,24 +9,42 @@
 // Scene constructure sets up window and sprite respawn times 
 Scene::Scene( sf::RenderWindow& gameWindow ) : window(gameWindow), quadtree(0.0f, 0.0f, Constants::WORLD_WIDTH, Constants::WORLD_HEIGHT){ 
     MetaComponents::view = sf::View(Constants::VIEW_RECT); 
-    log_info("scene made"); 
+    LOG_INFO(Scenes, "scene made"); 
 }
 
 void Scene::runScene() {
+    stepScene();
+    renderScene(1.0f);
+}
+
+void Scene::stepScene() {
     if (FlagSystem::flagEvents.gameEnd) return; // Early exit if game ended
-    
-    setTime();
+    PROFILE_ZONE("stepScene");
 
-    handleInput();
+    storePreviousState();
+    { PROFILE_ZONE("setTime"); setTime(); }
 
-    respawnAssets();
+    { PROFILE_ZONE("handleInput"); handleInput(); }
 
-    handleGameEvents();
-    handleGameFlags();
-    handleSceneFlags();
+    { PROFILE_ZONE("respawnAssets"); respawnAssets(); }
+
+    {
+        PROFILE_ZONE("handleGameEvents");
+        handleGameEvents();
+        handleGameFlags();
+        handleSceneFlags();
+    }
 
-    update();
-    draw();
+    { PROFILE_ZONE("update"); update(); }
+}
+
+void Scene::renderScene(float alpha) {
+    if (FlagSystem::flagEvents.gameEnd) return; 
+    if (!window.isOpen()) return; // headless, there is nothing to draw into 
+    PROFILE_ZONE("renderScene");
+
+    { PROFILE_ZONE("interpolate"); interpolate(alpha); }
+    { PROFILE_ZONE("draw"); draw(); }
 }
 
 void Scene::draw(){
@@ -85,13 +103,13 @@ void gamePlayScene::createAssets() {
 
         // Sprite vectors
         std::weak_ptr<sf::Uint8[]> cloudBlueBitmaskWeakPtr = Constants::CLOUDBLUE_BITMASK;  
-        cloudBlue.push_back(std::make_unique<Cloud>(Constants::CLOUDBLUE_POSITION, Constants::CLOUDBLUE_SCALE, Constants::CLOUDBLUE_TEXTURE, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudBlueBitmaskWeakPtr));
+        cloudBlue.push_back(std::make_unique<Cloud>(Constants::CLOUDBLUE_POSITION, Constants::CLOUDBLUE_SCALE, Constants::CLOUDBLUE_TEXTURE, Constants::CLOUDBLUE_RECT, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudBlueBitmaskWeakPtr));
         
         std::weak_ptr<sf::Uint8[]> cloudPurpleBitmaskWeakPtr = Constants::CLOUDPURPLE_BITMASK;  
-        cloudPurple.push_back(std::make_unique<Cloud>(Constants::CLOUDPURPLE_POSITION, Constants::CLOUDBLUE_SCALE, Constants::CLOUDPURPLE_TEXTURE, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudPurpleBitmaskWeakPtr));
+        cloudPurple.push_back(std::make_unique<Cloud>(Constants::CLOUDPURPLE_POSITION, Constants::CLOUDBLUE_SCALE, Constants::CLOUDPURPLE_TEXTURE, Constants::CLOUDPURPLE_RECT, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudPurpleBitmaskWeakPtr));
 
         std::weak_ptr<sf::Uint8[]> coinBitmaskWeakPtr = Constants::COIN_BITMASK;  
-        coins.push_back(std::make_unique<Coin>(Constants::COIN_POSITION, Constants::COIN_SCALE, Constants::COIN_TEXTURE, Constants::COIN_SPEED, Constants::COIN_ACCELERATION, coinBitmaskWeakPtr));
+        coins.push_back(std::make_unique<Coin>(Constants::COIN_POSITION, Constants::COIN_SCALE, Constants::COIN_TEXTURE, Constants::COIN_RECT, Constants::COIN_SPEED, Constants::COIN_ACCELERATION, coinBitmaskWeakPtr));
 
         // Background sprite
         background = std::make_unique<Background>(Constants::BACKGROUND_POSITION, Constants::BACKGROUND_SCALE, Constants::BACKGROUND_TEXTURE);
@@ -110,7 +128,7 @@ void gamePlayScene::createAssets() {
         for (int i = 0; i < Constants::TILES_NUMBER; ++i) {
             tiles1.at(i) = std::make_shared<Tile>(Constants::TILES_SCALE, Constants::TILES_TEXTURE, Constants::TILES_SINGLE_RECTS[i], Constants::TILES_BITMASKS[i], Constants::TILES_BOOLS[i]); 
         }
-        tileMap1 = std::make_unique<TileMap>(tiles1.data(), Constants::TILES_NUMBER, Constants::TILEMAP_WIDTH, Constants::TILEMAP_HEIGHT, Constants::TILE_WIDTH, Constants::TILE_HEIGHT, Constants::TILEMAP_FILEPATH, Constants::TILEMAP_POSITION); 
+        tileMap1 = std::make_unique<TileMap>(tiles1.data(), Constants::TILES_NUMBER, Constants::TILEMAP_WIDTH, Constants::TILEMAP_HEIGHT, Constants::TILE_WIDTH, Constants::TILE_HEIGHT, Constants::TILEMAP_FILEPATH, Constants::TILEMAP_POSITION, Constants::TILEMAP_STREAMING_BUDGET); 
 
         // Music
         backgroundMusic = std::make_unique<MusicClass>(std::move(Constants::BACKGROUNDMUSIC_MUSIC), Constants::BACKGROUNDMUSIC_VOLUME);
@@ -118,15 +136,18 @@ void gamePlayScene::createAssets() {
         if(backgroundMusic) backgroundMusic->returnMusic().setLoop(Constants::BACKGROUNDMUSIC_LOOP);
 
         // Sound
+        Constants::waitForAsset(Constants::SOUNDS_LOADED); 
         playerJumpSound = std::make_unique<SoundClass>(Constants::PLAYERJUMP_SOUNDBUFF, Constants::PLAYERJUMPSOUND_VOLUME); 
         coinHitSound = std::make_unique<SoundClass>(Constants::COINHIT_SOUNDBUFF, Constants::COINHITSOUND_VOLUME); 
         buttonClickSound = std::make_unique<SoundClass>(Constants::BUTTONCLICK_SOUNDBUFF, Constants::BUTTONCLICKSOUND_VOLUME);
 
         // Text
+        Constants::waitForAsset(Constants::FONT_LOADED); 
         introText = std::make_unique<TextClass>(Constants::TEXT_POSITION, Constants::TEXT_SIZE, Constants::TEXT_COLOR, Constants::TEXT_FONT, Constants::TEXT_MESSAGE);
         scoreText = std::make_unique<TextClass>(Constants::SCORETEXT_POSITION, Constants::SCORETEXT_SIZE, Constants::SCORETEXT_COLOR, Constants::TEXT_FONT, Constants::SCORETEXT_MESSAGE);
         endingText = std::make_unique<TextClass>(Constants::ENDINGTEXT_POSITION, Constants::ENDINGTEXT_SIZE, Constants::ENDINGTEXT_COLOR, Constants::TEXT_FONT, Constants::ENDINGTEXT_MESSAGE);
         endingText->setVisibleState(false);
+        performanceHud = std::make_unique<PerformanceHud>(Constants::HUDTEXT_POSITION, Constants::HUDTEXT_SIZE, Constants::HUDTEXT_COLOR, Constants::TEXT_FONT, Constants::HUD_REFRESH_TIME);
 
         insertItemsInQuadtree(); 
         setInitialTimes();
@@ -134,7 +155,7 @@ void gamePlayScene::createAssets() {
         globalTimer.End("initializing assets in scene 1"); // for logging purposes
     } 
     catch (const std::exception& e) {
-        log_error("Exception in createAssets: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in createAssets: {}", e.what());
     }
 }
 
@@ -157,21 +178,21 @@ void gamePlayScene::respawnAssets(){
     if(cloudBlueRespawnTime <= 0 && cloudBlue.size() < Constants::CLOUDBLUE_LIMIT){
         float newCloudBlueInterval = Constants::CLOUDBLUE_INITIAL_RESPAWN_TIME - MetaComponents::globalTime * 0.38;
         std::weak_ptr<sf::Uint8[]> cloudBlueBitmaskWeakPtr = Constants::CLOUDBLUE_BITMASK;  
-        cloudBlue.push_back(std::make_unique<Cloud>(Constants::makeRandomPositionCloud(), Constants::CLOUDBLUE_SCALE, Constants::CLOUDBLUE_TEXTURE, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudBlueBitmaskWeakPtr));
+        cloudBlue.push_back(std::make_unique<Cloud>(Constants::makeRandomPositionCloud(), Constants::CLOUDBLUE_SCALE, Constants::CLOUDBLUE_TEXTURE, Constants::CLOUDBLUE_RECT, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudBlueBitmaskWeakPtr));
         quadtree.insert(cloudBlue[cloudBlue.size() - 1]);
         cloudBlueRespawnTime = std::max(newCloudBlueInterval, Constants::CLOUDBLUE_INITIAL_RESPAWN_TIME);
     }
     if(cloudPurpleRespawnTime <= 0 && cloudPurple.size() < Constants::CLOUDPURPLE_LIMIT){
         float newCloudPurpleInterval = Constants::CLOUDPURPLE_INITIAL_RESPAWN_TIME - MetaComponents::globalTime * 0.38;
         std::weak_ptr<sf::Uint8[]> cloudPurpleBitmaskWeakPtr = Constants::CLOUDPURPLE_BITMASK;  
-        cloudPurple.push_back(std::make_unique<Cloud>(Constants::makeRandomPositionCloud(), Constants::CLOUDBLUE_SCALE, Constants::CLOUDPURPLE_TEXTURE, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudPurpleBitmaskWeakPtr));
+        cloudPurple.push_back(std::make_unique<Cloud>(Constants::makeRandomPositionCloud(), Constants::CLOUDBLUE_SCALE, Constants::CLOUDPURPLE_TEXTURE, Constants::CLOUDPURPLE_RECT, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, cloudPurpleBitmaskWeakPtr));
         quadtree.insert(cloudPurple[cloudPurple.size() - 1]);
         cloudPurpleRespawnTime = std::max(newCloudPurpleInterval, Constants::CLOUDPURPLE_INITIAL_RESPAWN_TIME);
     }
     if(coinRespawnTime <= 0 && coins.size() < Constants::COIN_LIMIT){
         float newCoinInterval = Constants::COIN_INITIAL_RESPAWN_TIME - MetaComponents::globalTime * 0.38;
         std::weak_ptr<sf::Uint8[]> coinBitmaskWeakPtr = Constants::COIN_BITMASK;  
-        coins.push_back(std::make_unique<Coin>(Constants::makeRandomPositionCoin(), Constants::COIN_SCALE, Constants::COIN_TEXTURE, Constants::COIN_SPEED, Constants::COIN_ACCELERATION, coinBitmaskWeakPtr));
+        coins.push_back(std::make_unique<Coin>(Constants::makeRandomPositionCoin(), Constants::COIN_SCALE, Constants::COIN_TEXTURE, Constants::COIN_RECT, Constants::COIN_SPEED, Constants::COIN_ACCELERATION, coinBitmaskWeakPtr));
         quadtree.insert(coins[coins.size() - 1]);
         coinRespawnTime = std::max(newCoinInterval, Constants::COIN_INITIAL_RESPAWN_TIME);
     }
@@ -182,7 +203,7 @@ void gamePlayScene::handleInvisibleSprites() {
         for (auto& asset : assetList) {
            if(asset && !(*asset).getVisibleState()){
                 asset->changePosition(positionCallback());
-                asset->updatePos();
+                asset->storePreviousPosition(); // respawns jump, so don't interpolate them
                 asset->setVisibleState(true);
             }
         }
@@ -215,14 +236,14 @@ void gamePlayScene::handleMouseClick() {
     if (FlagSystem::flagEvents.mouseClicked) {
         if (button1->getVisibleState() && 
             physics::collisionHelper(button1, MetaComponents::mouseClickedPosition_f)) {
-            log_info("button clicked");
+            LOG_INFO(Scenes, "button clicked");
 
             button1->setClickedBool(true);
             buttonClickSound->returnSound().play();
             FlagSystem::gameSceneNextFlags.sceneStart = true;
             FlagSystem::gameSceneNextFlags.sceneEnd = false;
 
-            window.clear();
+            if (window.isOpen()) window.clear(); // not when headless, clearing a closed window still wants a GL context
         }
     }
 }
@@ -263,38 +284,26 @@ void gamePlayScene::handleGameEvents() {
     scoreText->getText().setPosition(MetaComponents::view.getCenter().x - 460, MetaComponents::view.getCenter().y - 270);
     scoreText->getText().setString("Score: " + std::to_string(score));
 
-    for(auto it = coins.begin(); it != coins.end(); ++it){
-        if(physics::collisionHelper(player, *it, physics::boundingBoxCollision)){
-            (*it)->setVisibleState(false);
-            coinHitSound->returnSound().play();
-            score += 50;
-        }
+    for (Coin* coin : physics::collisionHelperBatch(player, coins, physics::boundingBoxCollision)) {
+        coin->setVisibleState(false);
+        coinHitSound->returnSound().play();
+        score += 50;
     }
 
-    bool touchingCloud = false;
-    auto checkCloudCollisions = [&](const std::vector<std::unique_ptr<Cloud>>& clouds) {
-        for (const auto& cloud : clouds) {
-            if (player && cloud) {
-                bool isTouchingThisCloud = physics::collisionHelper(player, cloud, physics::pixelPerfectCollision);
-                if (isTouchingThisCloud) {
-                    touchingCloud = true;
+    // Check collisions for both blue and purple clouds
+    bool touchingCloud = !physics::collisionHelperBatch(player, cloudBlue, physics::pixelPerfectCollision).empty() ||
+                         !physics::collisionHelperBatch(player, cloudPurple, physics::pixelPerfectCollision).empty();
 
-                    if(MetaComponents::spacePressedElapsedTime == MetaComponents::deltaTime){
-                        if(playerJumpSound) playerJumpSound->returnSound().play();
-                    }
+    // solid (not walkable) tiles hold the player up like the clouds do
+    bool touchingSolidTile = tileMap1 && !physics::tileCollisions(player, *tileMap1, TileFilter::Solid, true).empty();
+    bool supported = touchingCloud || touchingSolidTile;
 
-                    break; // Stop checking further once touching a cloud
-                }
-            }
-        }
-    };
-
-    // Check collisions for both blue and purple clouds
-    checkCloudCollisions(cloudBlue);
-    checkCloudCollisions(cloudPurple);
+    if (supported && MetaComponents::spacePressedElapsedTime == MetaComponents::deltaTime) {
+        if (playerJumpSound) playerJumpSound->returnSound().play();
+    }
 
-    //Update falling state based on whether the player is touching any cloud
-    FlagSystem::gameScene1Flags.playerFalling = !touchingCloud;
+    //Update falling state based on whether the player is standing on a cloud or a solid tile
+    FlagSystem::gameScene1Flags.playerFalling = !supported;
     FlagSystem::gameScene1Flags.playerJumping = MetaComponents::spacePressedElapsedTime > 0.0f;
     FlagSystem::gameScene1Flags.sceneEnd = !player->getMoveState();
 } 
@@ -322,15 +331,46 @@ void gamePlayScene::update() {
 
         updatePlayerAndView(); 
         quadtree.update(); 
+        if (tileMap1) tileMap1->updateStreaming(MetaComponents::getViewBounds()); 
 
         // Set the view for the window
         window.setView(MetaComponents::view);
         
     } catch (const std::exception& e) {
-        log_error("Exception in updateSprites: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in updateSprites: {}", e.what());
     }
 }
 
+// keeps the positions at the start of the step so draw can interpolate towards the new ones
+void gamePlayScene::storePreviousState(){
+    auto storeAll = [](auto& assetList) {
+        for (auto& asset : assetList) {
+            if (asset) asset->storePreviousPosition();
+        }
+    };
+    if (player) player->storePreviousPosition();
+    storeAll(cloudBlue);
+    storeAll(cloudPurple);
+    storeAll(coins);
+    previousViewCenter = MetaComponents::view.getCenter();
+}
+
+void gamePlayScene::interpolate(float alpha){
+    auto interpolateAll = [alpha](auto& assetList) {
+        for (auto& asset : assetList) {
+            if (asset) asset->interpolatePosition(alpha);
+        }
+    };
+    if (player) player->interpolatePosition(alpha);
+    interpolateAll(cloudBlue);
+    interpolateAll(cloudPurple);
+    interpolateAll(coins);
+
+    sf::View renderView = MetaComponents::view;
+    renderView.setCenter(previousViewCenter + (MetaComponents::view.getCenter() - previousViewCenter) * alpha);
+    window.setView(renderView);
+}
+
 void gamePlayScene::updateEntityStates(){ // manually change the sprite's state
     player->setJumpingState(FlagSystem::gameScene1Flags.playerJumping);
     player->setFallingState(FlagSystem::gameScene1Flags.playerFalling); 
@@ -384,7 +424,7 @@ void gamePlayScene::updateDrawablesVisibility(){
 
     }
     catch(const std::exception & e){
-        log_error("Exception in updateDrawablesVisibility: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in updateDrawablesVisibility: {}", e.what());
     }
 }
 
@@ -393,30 +433,69 @@ void gamePlayScene::draw() {
     try {
         window.clear(sf::Color::Blue); // set the base baskground color blue
 
+        size_t drawCalls = 0; // for the performance HUD
         auto drawAnythingVisible = [&](auto& drawable) {
-            if (drawable && drawable->getVisibleState()) window.draw(*drawable);
+            if (drawable && drawable->getVisibleState()) {
+                window.draw(*drawable);
+                ++drawCalls;
+            }
         };
     
         drawAnythingVisible(background);
-        drawAnythingVisible(tileMap1);
+        if (tileMap1 && tileMap1->getVisibleState()) {
+            window.draw(*tileMap1);
+            drawCalls += tileMap1->getChunksDrawn();
+        }
         drawAnythingVisible(button1);
-        for (auto& cloud : cloudBlue) drawAnythingVisible(cloud);
-        for (auto& cloud : cloudPurple) drawAnythingVisible(cloud);
-        for (auto& coin : coins) drawAnythingVisible(coin);
+
+        // clouds and coins share the texture atlas, so this is a single draw call
+        spriteBatch.begin(); 
+        spriteBatch.addAll(cloudBlue); 
+        spriteBatch.addAll(cloudPurple); 
+        spriteBatch.addAll(coins); 
+        spriteBatch.end(); 
+        window.draw(spriteBatch); 
+        drawCalls += spriteBatch.getBatchCount();
+
         drawAnythingVisible(player);
 
         drawAnythingVisible(introText);
         drawAnythingVisible(scoreText);
         drawAnythingVisible(endingText);
 
+        size_t collisionTests = std::exchange(physics::collisionTestCount, 0); // this frame's steps
+        if (FlagSystem::flagEvents.hudVisible && performanceHud) drawPerformanceHud(drawCalls, collisionTests);
+
         window.display(); 
     } 
     
     catch (const std::exception& e) {
-        log_error("Exception in draw: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in draw: {}", e.what());
     }
 }
 
+// frame times are the last frame's, the draw is still in progress
+void gamePlayScene::drawPerformanceHud(size_t drawCalls, size_t collisionTests) {
+    HudFrameStats stats;
+    stats.frameTime = MetaComponents::frameTime;
+    stats.simulationTime = MetaComponents::simulationTime;
+    stats.drawTime = MetaComponents::drawTime;
+    stats.drawCalls = drawCalls;
+    stats.collisionTests = collisionTests;
+    stats.cloudBlue = cloudBlue.size();
+    stats.cloudPurple = cloudPurple.size();
+    stats.coins = coins.size();
+    if (performanceHud->needsRefresh(stats.frameTime)) { // both walk the whole tree
+        stats.quadtreeNodes = quadtree.getNodeCount();
+        stats.quadtreeDepth = quadtree.getDepth();
+    }
+    performanceHud->addFrame(stats);
+
+    const sf::View& renderView = window.getView();
+    performanceHud->setViewTopLeft(renderView.getCenter() - renderView.getSize() / 2.0f);
+    window.draw(*performanceHud);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Game Scene #2 from down below 
@@ -430,7 +509,7 @@ void gamePlayScene2::createAssets() {
     } 
 
     catch (const std::exception& e) {
-        log_error("Exception in createAssets: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in createAssets: {}", e.what());
     }
 }
 
@@ -448,7 +527,7 @@ void gamePlayScene2::draw() {
     } 
     
     catch (const std::exception& e) {
-        log_error("Exception in gamePlayScene2 draw: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in gamePlayScene2 draw: {}", e.what());
     }
 }
 
@@ -460,6 +539,6 @@ void gamePlayScene2::update() {
         
     }
     catch (const std::exception& e) {
-        log_error("Exception in updateSprites: " + std::string(e.what()));
+        LOG_ERROR(Scenes, "Exception in updateSprites: {}", e.what());
     }
 }
@@ -27,7 +27,9 @@ class Scene {
   virtual ~Scene() = default; 
 
   // base functions inside scene
-  void runScene();  
+  void runScene(); // one step followed by a draw (the draw is skipped when headless)
+  void stepScene(); // one fixed timestep of input, events and updates 
+  void renderScene(float alpha); // alpha is how far the time is between the last step and the next one 
   virtual void createAssets(){}; 
 
  protected:
@@ -50,6 +52,8 @@ class Scene {
   virtual void updateDrawablesVisibility(){}; 
 
   virtual void update(){};
+  virtual void storePreviousState(){}; 
+  virtual void interpolate(float alpha){}; 
   virtual void draw(); 
   virtual void moveViewPortWASD();
 
@@ -95,12 +99,15 @@ class gamePlayScene : public virtual Scene{
   void handleSceneFlags() override; 
 
   void update() override; 
+  void storePreviousState() override; 
+  void interpolate(float alpha) override; 
   void updateDrawablesVisibility() override; 
   void updatePlayerAndView(); 
   void updateEntityStates(); 
   void changeAnimation();
 
   void draw() override; 
+  void drawPerformanceHud(size_t drawCalls, size_t collisionTests); 
 
   std::unique_ptr<Background> background; 
   std::unique_ptr<Player> player; 
@@ -122,6 +129,12 @@ class gamePlayScene : public virtual Scene{
   std::unique_ptr<TextClass> introText; 
   std::unique_ptr<TextClass> scoreText; 
   std::unique_ptr<TextClass> endingText; 
+  std::unique_ptr<PerformanceHud> performanceHud; // drawn while flagEvents.hudVisible 
+
+  // clouds and coins are drawn as one vertex array per texture (one in total when they share the atlas) 
+  SpriteBatch spriteBatch; 
+
+  sf::Vector2f previousViewCenter {}; 
 
   float cloudBlueRespawnTime {};
   float cloudPurpleRespawnTime {};
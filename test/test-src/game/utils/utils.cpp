@@ -5,6 +5,12 @@
 
 #include "utils.hpp"
 
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace utils {
     std::vector<std::weak_ptr<unsigned char[]>> convertToWeakPtrVector(const std::vector<std::shared_ptr<unsigned char[]>>& bitMask) {
         std::vector<std::weak_ptr<unsigned char[]>> result;
@@ -17,4 +23,99 @@ namespace utils {
 
         return result;
     }
+
+    std::uint64_t hashFile(const std::filesystem::path& filePath) {
+        MappedFile file(filePath);
+        if (!file) return 0;
+
+        // 8 bytes at a time, the tail zero padded; the size is mixed in so trailing zeros still count
+        std::uint64_t hash = splitMix64(file.size());
+        size_t offset = 0;
+        for (; offset + 8 <= file.size(); offset += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, file.data() + offset, 8);
+            hash = splitMix64(hash ^ word);
+        }
+        if (offset < file.size()) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, file.data() + offset, file.size() - offset);
+            hash = splitMix64(hash ^ word);
+        }
+        return hash ? hash : 1; // 0 means unreadable
+    }
+
+    std::vector<AtlasSlot> packShelves(const std::vector<AtlasSlot>& sizes, int atlasWidth, int padding, int& atlasHeight) {
+        std::vector<AtlasSlot> slots(sizes);
+        std::vector<size_t> order(sizes.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a].height > sizes[b].height; });
+
+        int shelfX = 0, shelfY = 0, shelfHeight = 0;
+        for (size_t index : order) {
+            AtlasSlot& slot = slots[index];
+            if (shelfX > 0 && shelfX + slot.width > atlasWidth) { // start the next shelf
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+            }
+            slot.x = shelfX;
+            slot.y = shelfY;
+            shelfX += slot.width + padding;
+            shelfHeight = std::max(shelfHeight, slot.height + padding);
+        }
+
+        atlasHeight = shelfY + shelfHeight;
+        return slots;
+    }
+
+    TaskPool::TaskPool(unsigned int threads) {
+        threads = std::max(1u, threads);
+        workers.reserve(threads);
+        for (unsigned int i = 0; i < threads; ++i) workers.emplace_back(&TaskPool::work, this);
+    }
+
+    TaskPool::~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    void TaskPool::work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return; // stopping, and nothing left to run
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    MappedFile::MappedFile(const std::filesystem::path& filePath, bool copyOnWrite) : copyOnWrite(copyOnWrite) {
+        int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0) return;
+
+        struct stat fileStat {};
+        if (::fstat(fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0) {
+            int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ; // MAP_PRIVATE doesn't need the file open for writing
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(fileStat.st_size), protection, MAP_PRIVATE, fileDescriptor, 0);
+            if (mapped != MAP_FAILED) {
+                mapping = mapped;
+                mappedSize = static_cast<size_t>(fileStat.st_size);
+            }
+        }
+        ::close(fileDescriptor); // the mapping stays valid after the descriptor is closed
+    }
+
+    MappedFile::~MappedFile() {
+        if (mapping) ::munmap(mapping, mappedSize);
+    }
 }
@@ -8,10 +8,160 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <iterator>
+#include <filesystem>
+#include <cstdint>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <type_traits>
 
-/* utils namespace includes a convertToWeakPtrVector to convert shared_ptr vectors into weak_ptr vectors */
+/* utils namespace includes a convertToWeakPtrVector to convert shared_ptr vectors into weak_ptr vectors, MappedFile for 
+reading files straight from memory, a shelf packer for texture atlases, a small worker pool, and a seedable PRNG and noise for 
+procedural generation */
 namespace utils {
     // for sprite consturction 
     std::vector<std::weak_ptr<unsigned char[]>> convertToWeakPtrVector(const std::vector<std::shared_ptr<unsigned char[]>>& bitMask);
 
+    // read-only mmap of a whole file; pages are only read from disk when touched. empty if the file couldn't be mapped
+    class MappedFile {
+    public:
+        // copyOnWrite maps the pages writable but private: writes go to this process's copy of a page, never to the file
+        explicit MappedFile(const std::filesystem::path& filePath, bool copyOnWrite = false);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+        unsigned char* writableData() { return copyOnWrite ? static_cast<unsigned char*>(mapping) : nullptr; } 
+        size_t size() const { return mappedSize; }
+        explicit operator bool() const { return mapping != nullptr; }
+
+    private:
+        void* mapping = nullptr;
+        size_t mappedSize = 0;
+        bool copyOnWrite = false;
+    };
+
+    // 64-bit hash of a file's contents, for noticing when a source file changed; 0 if it can't be read
+    std::uint64_t hashFile(const std::filesystem::path& filePath);
+
+    // position (and size) of one packed rect
+    struct AtlasSlot {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    /* shelf packing: rects go left to right on rows ("shelves") as tall as their tallest rect, tallest first so little height is 
+    wasted. returns one slot per size, in the order given, and the height the packed rects need. padding is left free right of 
+    and below every rect */
+    std::vector<AtlasSlot> packShelves(const std::vector<AtlasSlot>& sizes, int atlasWidth, int padding, int& atlasHeight);
+
+    // fixed set of worker threads running submitted tasks in order; the destructor finishes queued tasks, then joins 
+    class TaskPool {
+    public:
+        explicit TaskPool(unsigned int threads = std::thread::hardware_concurrency());
+        ~TaskPool();
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        // the future holds the task's result, or the exception it threw
+        template<typename Task>
+        std::future<std::invoke_result_t<Task>> submit(Task&& task) {
+            auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<Task>()>>(std::forward<Task>(task));
+            std::future<std::invoke_result_t<Task>> result = packaged->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.emplace_back([packaged] { (*packaged)(); });
+            }
+            wake.notify_one();
+            return result;
+        }
+
+        size_t getThreadCount() const { return workers.size(); }
+
+    private:
+        void work();
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+    };
+
+    // splitmix64 step; spreads seeds and coordinates over all 64 bits
+    inline std::uint64_t splitMix64(std::uint64_t value) {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // stateless hash of a seed and a coordinate, so any cell or column can be generated on its own (and on any thread)
+    inline std::uint64_t hashSeed(std::uint64_t seed, std::uint64_t coordinate) {
+        return splitMix64(seed ^ splitMix64(coordinate));
+    }
+
+    // xoshiro256** (Blackman and Vigna); a few cycles per number and the same sequence for the same seed on every platform, unlike std::rand
+    class Xoshiro256 {
+    public:
+        explicit Xoshiro256(std::uint64_t seed) {
+            for (auto& word : state) {
+                seed = splitMix64(seed);
+                word = seed;
+            }
+        }
+
+        std::uint64_t next() {
+            const std::uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+            const std::uint64_t shifted = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= shifted;
+            state[3] = rotateLeft(state[3], 45);
+            return result;
+        }
+
+        // in [0, bound); multiply and shift instead of %, the bias is below 2^-32
+        std::uint32_t nextBelow(std::uint32_t bound) { return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32); }
+        float nextFloat() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); } // in [0, 1)
+
+    private:
+        static std::uint64_t rotateLeft(std::uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+        std::uint64_t state[4];
+    };
+
+    // 1D value noise in [0, 1]: random values at whole x, smoothstep between them
+    inline float valueNoise(std::uint64_t seed, float x) {
+        float cell = std::floor(x);
+        float t = x - cell;
+        t = t * t * (3.0f - 2.0f * t);
+        std::int64_t index = static_cast<std::int64_t>(cell);
+        float left = static_cast<float>(hashSeed(seed, static_cast<std::uint64_t>(index)) >> 40) * (1.0f / 16777216.0f);
+        float right = static_cast<float>(hashSeed(seed, static_cast<std::uint64_t>(index + 1)) >> 40) * (1.0f / 16777216.0f);
+        return left + (right - left) * t;
+    }
+
+    // octaves of value noise, each twice the frequency and half the weight of the last; still in [0, 1]
+    inline float fractalNoise(std::uint64_t seed, float x, unsigned int octaves) {
+        float sum = 0.0f, weight = 1.0f, totalWeight = 0.0f;
+        for (unsigned int octave = 0; octave < octaves; ++octave) {
+            sum += valueNoise(seed + octave, x) * weight;
+            totalWeight += weight;
+            x *= 2.0f;
+            weight *= 0.5f;
+        }
+        return totalWeight > 0.0f ? sum / totalWeight : 0.0f;
+    }
 }
@@ -1,8 +1,85 @@
-
 #include "game/core/game.hpp"
+#include "../test-testing/testing.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+static int printUsage(const char* program) {
+    std::cerr << "usage: " << program << " [--headless [steps [script]] | --benchmark | --convert-tilemap <in.txt> <out.tmb>]" << std::endl;
+    return 1; 
+}
+
+// pass --headless [steps [script]] to run the simulation without a window, e.g. for CI or throughput measurements. input comes 
+// from the script file (default game/core/headless_input.txt, format in game.hpp). textures are decoded but never uploaded 
+// (sprites take their size from the images), so no GL context is needed either. 
+// --benchmark times the bulk movement kernels against spriteMover, checks they agree and exits 
+// --convert-tilemap writes a text tile map as a binary .tmb map, sized by the tilemap and tiles settings in config.yaml 
+int main(int argc, char* argv[]){
+    bool headless = argc > 1 && std::strcmp(argv[1], "--headless") == 0; 
+    bool benchmark = argc > 1 && std::strcmp(argv[1], "--benchmark") == 0; 
+    bool convertTileMap = argc > 1 && std::strcmp(argv[1], "--convert-tilemap") == 0; 
+    unsigned int steps = 10000; 
+    std::filesystem::path scriptFile = "test/test-src/game/core/headless_input.txt"; 
+    if ((argc > 1 && !headless && !benchmark && !convertTileMap) || (benchmark && argc > 2) || (convertTileMap && argc != 4) || argc > 4) {
+        return printUsage(argv[0]); 
+    }
+
+    if (convertTileMap) {
+        try {
+            Constants::readFromYaml(Constants::CONFIG_FILE); // only the settings, no assets are loaded
+            TileMap::convertTextToBinary(argv[2], argv[3], Constants::TILEMAP_WIDTH, Constants::TILEMAP_HEIGHT, Constants::TILE_WIDTH, 
+                                         Constants::TILE_HEIGHT, Constants::TILES_NUMBER); 
+        } catch (const std::exception& e) {
+            log_error("Failed to convert tile map: " + std::string(e.what())); 
+            return 1; 
+        }
+        return 0; 
+    }
+
+    if (headless && argc > 3) scriptFile = argv[3]; 
+    if (headless && argc > 2) {
+        try {
+            size_t parsed = 0; 
+            unsigned long value = std::isdigit(static_cast<unsigned char>(argv[2][0])) ? std::stoul(argv[2], &parsed) : 0; 
+            if (parsed != std::strlen(argv[2]) || value == 0 || value > std::numeric_limits<unsigned int>::max()) {
+                throw std::invalid_argument(argv[2]);
+            }
+            steps = static_cast<unsigned int>(value); 
+        } catch (const std::exception&) {
+            std::cerr << "steps must be a whole number from 1 to " << std::numeric_limits<unsigned int>::max() << ", got \"" << argv[2] << "\"" << std::endl;
+            return printUsage(argv[0]); 
+        }
+    }
+
+    std::vector<ScriptedEvent> script; 
+    if (headless) {
+        try {
+            script = readInputScript(scriptFile); 
+        } catch (const std::exception& e) {
+            log_error("Failed to read input script: " + std::string(e.what())); 
+            return 1; 
+        }
+    }
+
+    try {
+        Constants::initialize(headless); 
+    } catch (const std::exception& e) {
+        log_error("Failed to initialize: " + std::string(e.what())); 
+        return 1; 
+    }
+
+    if (benchmark) return runMovementBenchmark() ? 0 : 1; 
 
-int main(){
-    Constants::initialize(); 
+    if (headless) {
+        GameManager headlessGame(std::move(script)); 
+        headlessGame.runHeadless(steps); 
+        return 0; 
+    }
 
     GameManager game1; 
     game1.runGame();
@@ -1 +1,66 @@
 #include "testing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "../test-src/game/physics/physics.hpp"
+
+bool runMovementBenchmark() {
+    constexpr int iterations = 100;
+    MetaComponents::deltaTime = 1.0f / 60.0f;
+
+    auto timeMillis = [](auto&& func) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) func();
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    std::cout << "entities | spriteMover moveLeft | moveLeftBulk | spriteMover freeFall | freeFallBulk | spriteMover follow | followBulk (ms per pass)" << std::endl;
+
+    bool matched = true; 
+    for (size_t count : { 1000u, 10000u, 100000u, 1003u }) { // 1003 leaves a scalar tail behind the SIMD loops
+        std::vector<std::unique_ptr<Cloud>> clouds;
+        clouds.reserve(count);
+        std::weak_ptr<sf::Uint8[]> bitmask = Constants::CLOUDBLUE_BITMASK;
+        for (size_t i = 0; i < count; ++i) {
+            clouds.push_back(std::make_unique<Cloud>(Constants::CLOUDBLUE_POSITION, Constants::CLOUDBLUE_SCALE, Constants::CLOUDBLUE_TEXTURE, Constants::CLOUDBLUE_RECT, Constants::CLOUDBLUE_SPEED, Constants::CLOUDBLUE_ACCELERATION, bitmask));
+            clouds.back()->setDirectionVector({ -1.0f, 0.5f });
+        }
+        // the same entities packed into arrays for the bulk kernels
+        std::vector<float> positionX(count), positionY(count), directionX(count), directionY(count);
+        std::vector<float> speed(count), accelerationX(count), accelerationY(count);
+        for (size_t i = 0; i < count; ++i) {
+            positionX[i] = clouds[i]->getSpritePos().x;
+            positionY[i] = clouds[i]->getSpritePos().y;
+            directionX[i] = clouds[i]->getDirectionVector().x;
+            directionY[i] = clouds[i]->getDirectionVector().y;
+            speed[i] = clouds[i]->getSpeed();
+            accelerationX[i] = clouds[i]->getAcceleration().x;
+            accelerationY[i] = clouds[i]->getAcceleration().y;
+        }
+
+        float moverLeft = timeMillis([&] { for (auto& cloud : clouds) physics::spriteMover(cloud, physics::moveLeft); });
+        float bulkLeft = timeMillis([&] { physics::moveLeftBulk(positionX.data(), speed.data(), accelerationX.data(), count); });
+        float moverFall = timeMillis([&] { for (auto& cloud : clouds) physics::spriteMover(cloud, physics::freeFall); });
+        float bulkFall = timeMillis([&] { physics::freeFallBulk(positionY.data(), speed.data(), count); });
+        float moverFollow = timeMillis([&] { for (auto& cloud : clouds) physics::spriteMover(cloud, physics::follow); });
+        float bulkFollow = timeMillis([&] { physics::followBulk(positionX.data(), positionY.data(), directionX.data(), directionY.data(), 
+                                                                speed.data(), accelerationX.data(), accelerationY.data(), count); });
+
+        std::cout << count << " | " << moverLeft << " | " << bulkLeft << " | " << moverFall << " | " << bulkFall
+                  << " | " << moverFollow << " | " << bulkFollow << std::endl;
+
+        // both sides ran the same moves on the same start state; only float rounding may tell them apart
+        float worstError = 0.0f; 
+        for (size_t i = 0; i < count; ++i) {
+            sf::Vector2f expected = clouds[i]->getSpritePos(); 
+            worstError = std::max({ worstError, std::abs(positionX[i] - expected.x) / (1.0f + std::abs(expected.x)),
+                                                std::abs(positionY[i] - expected.y) / (1.0f + std::abs(expected.y)) });
+        }
+        if (worstError > 1e-4f) {
+            std::cout << "bulk kernels don't match spriteMover at " << count << " entities (relative error " << worstError << ")" << std::endl;
+            matched = false; 
+        }
+    }
+    return matched; 
+}
@@ -15,3 +15,6 @@
 
 #endif 
 
+// compares per-sprite spriteMover calls against the bulk movement kernels at 1k/10k/100k entities (needs Constants::initialize first). 
+// returns false when the kernels end up with other positions than spriteMover on the same input; run with --benchmark
+bool runMovementBenchmark();